@@ -403,6 +403,8 @@ public:
 	static uint32_t   addrDispFlags;
 	static int        addrPrintWidth;
 
+	static int        getAddrPrintWidth();
+
 	uint8_t           coreId;
         uint8_t           prv;
 	uint32_t          pid;
@@ -817,6 +819,7 @@ private:
     char                  *cutPath;
     char                  *newRoot;
 	class ElfReader       *elfReader;
+	bool                   sharedElfReader;
 	class Disassembler    *disassembler;
 };
 
@@ -848,6 +851,21 @@ public:
     ~Trace();
     void cleanUp();
     static const char *version();
+    static void setElfCaching(bool enable);
+    static void setLibImageCaching(bool enable);
+    static void setNativeElfLoader(bool enable);
+    static void setElfCacheDir(const char *dir);
+    static void setElfLoadTimes(bool enable);
+    static void setKMemPrewarm(bool enable);
+    static void setPredecodeLimit(uint32_t limit);
+    static void setThreadDisplaySettings(bool enable);
+    static void setThreadMessageFile(FILE *msgFile);
+    static FILE *getThreadMessageFile();
+    static void setSrcIndexing(bool enable);
+    static void setSrcIndexFile(const char *file);
+    static void setStartupTimes(bool enable);
+    static TraceDqr::DQErr objDumpBenchmark(const char *odTextName);
+    static TraceDqr::DQErr decodeSelfTest(uint32_t numSamples);
     TraceDqr::DQErr setTraceType(TraceDqr::TraceType tType);
     TraceDqr::DQErr setErrorMode(bool tolerate);
 	TraceDqr::DQErr setTSSize(int size);
@@ -901,6 +919,8 @@ public:
 	TraceDqr::DQErr getNumBytesInSWTQ(int &numBytes);
 
 private:
+	friend class ProcessLoader;
+
 	enum state {
 		TRACE_STATE_SYNCCATE,
 		TRACE_STATE_GETFIRSTSYNCMSG,
@@ -922,6 +942,7 @@ private:
 	int                    numPids;
 	int                   *pidList;
 	class KMem            *kMem; // all proceses use the same kMem object
+	class ProcessLoader   *processLoader; // builds linux processes as their pids show up, or nullptr
 	char                  *objdump;
 	char                  *rtdName;
 	char                  *vdsoName;
@@ -947,6 +968,24 @@ private:
 	class Disassembler    *currentDisassembler[DQR_MAXCORES];
 	class ElfReader       *currentElfReader[DQR_MAXCORES];
 
+	// pid to process index hash (open addressing, -1 is an empty slot) for linux traces. Only holds the
+	// processes whose pids are being decoded
+
+	int                   *pidIndex;
+	uint32_t               pidIndexMask;
+
+	// recently active process contexts for each core, most recent first. Entry 0 is the current context
+
+	enum { procCacheSize = 4 };
+
+	struct processContext {
+		int pid;
+		int processIndex;	// -1 if the pid is not decoded, -2 if the entry is unused
+		int sectionHint;	// last hit in the section index of the process's elf reader
+	};
+
+	processContext         procCache[DQR_MAXCORES][procCacheSize];
+
 	int              srcbits;
 	bool             bufferItc;
 	int              enterISR[DQR_MAXCORES];
@@ -962,6 +1001,7 @@ private:
 
 	uint32_t         freq;
 	int              archSize;
+	uint64_t         predecodeLimit;
 
 	Analytics        analytics;
 
@@ -982,11 +1022,35 @@ private:
 	TraceDqr::DQErr configure(class TraceSettings &settings);
 	void resetTrace(int core);
 
+	// phases of configure() that are run at the same time by runStartupPhases()
+
+	enum startupPhase {
+		startupProcesses,
+		startupTraceFile,
+		startupCATrace,
+		startupKMem,
+		startupNLSStrings,
+		startupConverters,
+	};
+
+	static bool startupTimes;
+
+	TraceDqr::DQErr runStartupPhases(const int *phases,int numPhases,class TraceSettings &settings);
+	TraceDqr::DQErr runStartupPhase(int phase,class TraceSettings &settings);
+	static void startupPhaseJob(void *jobs,int j);
+	TraceDqr::DQErr buildProcesses(class TraceSettings &settings);
+	TraceDqr::DQErr openTraceFile(class TraceSettings &settings);
+	TraceDqr::DQErr parseNLSStrings(class TraceSettings &settings);
+	TraceDqr::DQErr setupConverters(class TraceSettings &settings);
+	TraceDqr::DQErr startCATrace();
+
 	int decodeInstructionSize(uint32_t inst, int &inst_size);
 	int decodeInstruction(uint32_t instruction,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
+	TraceDqr::DQErr getPredecodedInstByAddress(TraceDqr::ADDRESS addr,struct predecodedInst &pdi);
 	TraceDqr::DQErr getCRBRFlags(TraceDqr::ICTReason cksrc,TraceDqr::ADDRESS addr,int &crFlag,int &brFlag);
 	TraceDqr::DQErr nextAddr(TraceDqr::ADDRESS addr,TraceDqr::ADDRESS &nextAddr,int &crFlag);
 	TraceDqr::DQErr nextAddr(int currentCore,TraceDqr::ADDRESS addr,TraceDqr::ADDRESS &pc,NexusMessage *nm,int &crFlag,TraceDqr::BranchFlags &brFlag);
+	int findNotTakenRun(TraceDqr::ADDRESS addr,int maxBranches,TraceDqr::ADDRESS &lastBranch);
 	TraceDqr::DQErr nextCAAddr(TraceDqr::ADDRESS &addr,TraceDqr::ADDRESS &savedAddr);
 
 	TraceDqr::ADDRESS computeAddress();
@@ -1000,6 +1064,9 @@ private:
 	TraceDqr::DQErr dumpTraceMessage(NexusMessage *tmsg);
 	TraceDqr::DQErr dumpTraceMessages();
 	int processPidPriv(int core,int pid,uint8_t v,uint8_t prv);
+	TraceDqr::DQErr buildPidIndex();
+	int findProcess(int pid);
+	void resetProcCache(int core);
 };
 
 class SRec {
@@ -1159,4 +1226,426 @@ private:
 	TraceDqr::DQErr buildInstructionFromVRec(VRec *vrec,uint32_t instruction,TraceDqr::BranchFlags brFlags,int crFlag);
 };
 
+// class BinTrace: layout of the binary decoded trace file written by BinTraceWriter (dqr -bin) and read by
+// BinTraceReader. The file is meant to be mapped and used in place:
+//
+//   header                         fixed size, at offset 0
+//   record[numRecords]             one fixed width record per instruction, plus the occasional sync record
+//   addrEntry[numAddrs]            one entry per distinct address/instruction pair: opcode, text, symbol, line
+//   symEntry[numSyms]              function names
+//   fileEntry[numFiles]            source file names
+//   lineEntry[numLines]            source lines: file, line number, text
+//   char strings[stringSize]       nul terminated strings the tables point into by offset
+//
+// All values are in host byte order (byteOrder reads as byteOrderMark when it matches) and every table starts
+// on an 8 byte boundary. Instruction records hold the change in pc and timestamp from the previous record of
+// the same core; when a change does not fit, a sync record with the full value comes first. Version is bumped
+// for any change a reader of the previous version would misread
+
+#ifdef SWIG
+	%ignore BinTrace;
+	%ignore BinTraceWriter;
+	%ignore BinTraceReader;
+#endif // SWIG
+
+class BinTrace {
+public:
+	enum {
+		version = 1,
+		byteOrderMark = 0x01020304,
+		noIndex = 0xffffffff,
+	};
+
+	enum recordKind {
+		recInstruction = 0,		// pcDelta, tsDelta, index of the addrEntry for the new pc
+		recPC = 1,			// pc = pcDelta (low 32 bits) | tsDelta (high 32 bits)
+		recTimestamp = 2,		// timestamp = pcDelta (low 32 bits) | tsDelta (high 32 bits)
+		recPid = 3,			// pid = index
+	};
+
+	enum headerFlags {
+		flagLinuxTrace = 0x01,		// records carry meaningful pids
+		flagTimestamps = 0x02,		// timestamps are cycle accurate and shown with each instruction
+	};
+
+	struct header {
+		char     magic[8];		// "DQRBIN\0\0"
+		uint32_t version;
+		uint32_t headerSize;
+		uint32_t byteOrder;
+		uint32_t recordSize;
+		uint32_t addrSize;		// Instruction::addrSize, addrDispFlags, addrPrintWidth when written
+		uint32_t addrDispFlags;
+		uint32_t addrPrintWidth;
+		uint32_t srcBits;		// non zero for multi-core traces
+		uint32_t flags;			// headerFlags
+		uint32_t reserved;
+		uint64_t numRecords;
+		uint64_t recordOffset;
+		uint64_t numAddrs;
+		uint64_t addrOffset;
+		uint64_t numSyms;
+		uint64_t symOffset;
+		uint64_t numFiles;
+		uint64_t fileOffset;
+		uint64_t numLines;
+		uint64_t lineOffset;
+		uint64_t stringSize;
+		uint64_t stringOffset;
+	};
+
+	struct record {
+		uint8_t  kind;			// recordKind
+		uint8_t  core;
+		uint8_t  crFlags;		// TraceDqr::CallReturnFlag bits
+		uint8_t  info;			// TraceDqr::BranchFlags in bits 0-1, privilege mode in bits 2-4
+		int32_t  pcDelta;
+		uint32_t tsDelta;
+		uint32_t index;
+	};
+
+	struct addrEntry {
+		uint64_t address;
+		uint32_t instruction;
+		uint32_t instSize;		// in bits
+		uint32_t text;			// string offset of the disassembly, or noIndex
+		uint32_t sym;			// symEntry index, or noIndex
+		uint32_t symOffset;
+		uint32_t line;			// lineEntry index, or noIndex
+	};
+
+	struct symEntry {
+		uint32_t name;
+	};
+
+	struct fileEntry {
+		uint32_t name;
+	};
+
+	struct lineEntry {
+		uint32_t file;			// fileEntry index
+		uint32_t lineNum;
+		uint32_t text;			// string offset, or noIndex
+	};
+
+	// one decoded instruction from BinTraceReader::nextInstruction()
+
+	struct instInfo {
+		TraceDqr::ADDRESS    address;
+		TraceDqr::TIMESTAMP  timestamp;
+		uint32_t             pid;
+		uint8_t              core;
+		uint8_t              prv;
+		uint8_t              crFlags;
+		uint8_t              brFlags;
+		const addrEntry     *addr;
+	};
+};
+
+// class BinTraceWriter: write decoded instructions to a binary trace file. Records are written as they are
+// added; the tables and the final header go out in close()
+
+class BinTraceWriter {
+public:
+	BinTraceWriter();
+	~BinTraceWriter();
+
+	TraceDqr::DQErr open(const char *fileName,int srcBits,uint32_t flags);
+	TraceDqr::DQErr addInstruction(Instruction *instInfo,Source *srcInfo);
+	TraceDqr::DQErr close();
+
+	TraceDqr::DQErr getStatus() { return status; }
+
+private:
+	enum {
+		recordBufferSize = 16384,
+		tableInitialSize = 1024,
+	};
+
+	TraceDqr::DQErr status;
+
+	FILE              *file;
+	char              *fileName;
+	BinTrace::header   hdr;
+
+	BinTrace::record  *records;
+	int                numBuffered;
+
+	TraceDqr::ADDRESS   lastPC[DQR_MAXCORES];
+	TraceDqr::TIMESTAMP lastTS[DQR_MAXCORES];
+	uint32_t            lastPid[DQR_MAXCORES];
+
+	// the tables, each with an open addressed hash of its entries. Hash slots hold entry index + 1 (string
+	// offset + 1 for strings), 0 is an empty slot
+
+	BinTrace::addrEntry *addrs;
+	uint32_t             numAddrs;
+	uint32_t             addrsSize;
+	uint32_t            *addrHash;
+	uint32_t             addrHashMask;
+
+	BinTrace::symEntry  *syms;
+	uint32_t             numSyms;
+	uint32_t             symsSize;
+	uint32_t            *symHash;
+	uint32_t             symHashMask;
+
+	BinTrace::fileEntry *files;
+	uint32_t             numFiles;
+	uint32_t             filesSize;
+	uint32_t            *fileHash;
+	uint32_t             fileHashMask;
+
+	BinTrace::lineEntry *lines;
+	uint32_t             numLines;
+	uint32_t             linesSize;
+	uint32_t            *lineHash;
+	uint32_t             lineHashMask;
+
+	char                *strings;
+	uint32_t             numStrings;
+	uint32_t             stringSize;
+	uint32_t             stringsSize;
+	uint32_t            *stringHash;
+	uint32_t             stringHashMask;
+
+	void cleanUp();
+	TraceDqr::DQErr putRecord(uint8_t kind,uint8_t core,uint8_t crFlags,uint8_t info,int32_t pcDelta,uint32_t tsDelta,uint32_t index);
+	TraceDqr::DQErr putSync(uint8_t kind,uint8_t core,uint64_t value);
+	TraceDqr::DQErr flushRecords();
+	TraceDqr::DQErr writeTable(const void *table,uint64_t size,uint64_t &offset);
+	static uint32_t *newHash(uint32_t count,uint32_t &hashMask);
+	static void insertHash(uint32_t *hash,uint32_t hashMask,uint32_t h,uint32_t slotValue);
+	uint32_t addString(const char *s);
+	uint32_t addSym(const char *name);
+	uint32_t addFile(const char *name);
+	uint32_t addLine(Source *srcInfo);
+	uint32_t addAddr(Instruction *instInfo,uint32_t line);
+};
+
+// class BinTraceReader: map a binary trace file and walk its records. nextInstruction() undoes the delta
+// encoding; getRecords() and the table accessors give direct access to the mapped data
+
+class BinTraceReader {
+public:
+	BinTraceReader();
+	~BinTraceReader();
+
+	TraceDqr::DQErr open(const char *fileName);
+	TraceDqr::DQErr getStatus() { return status; }
+
+	TraceDqr::DQErr nextInstruction(BinTrace::instInfo &inst);
+	void rewind();
+	void applyDisplaySettings();
+
+	const BinTrace::header    *getHeader() { return hdr; }
+	const BinTrace::record    *getRecords() { return records; }
+	uint64_t                   getNumRecords() { return (hdr != nullptr) ? hdr->numRecords : 0; }
+
+	const BinTrace::addrEntry *getAddr(uint32_t index);
+	const BinTrace::lineEntry *getLine(uint32_t index);
+	const char *getString(uint32_t offset);
+	const char *getSymName(uint32_t index);
+	const char *getFileName(uint32_t index);
+
+private:
+	TraceDqr::DQErr status;
+
+	class MappedFile          *file;
+	const BinTrace::header    *hdr;
+	const BinTrace::record    *records;
+	const BinTrace::addrEntry *addrs;
+	const BinTrace::symEntry  *syms;
+	const BinTrace::fileEntry *files;
+	const BinTrace::lineEntry *lines;
+	const char                *strings;
+
+	uint64_t            nextRecord;
+	TraceDqr::ADDRESS   pc[DQR_MAXCORES];
+	TraceDqr::TIMESTAMP ts[DQR_MAXCORES];
+	uint32_t            pid[DQR_MAXCORES];
+
+	bool checkTable(uint64_t offset,uint64_t count,uint64_t entrySize);
+};
+
+// class ColTrace: layout of the columnar decoded trace file written by ColTraceWriter (dqr -col) and read by
+// ColTraceReader. Rows are instructions; the columns are described in the file header so a reader does not
+// need to know them in advance:
+//
+//   header                                 magic, version, number of columns, rows per row group
+//   columnDesc[numColumns]                 name, value type, encoding, dictionary
+//   row groups, each:
+//     rowGroupHeader                       number of rows
+//     uint32_t columnSize[numColumns]      encoded size of each column chunk
+//     column chunks                        in column order, so a reader can skip the columns it doesn't use
+//   footer:
+//     uint32_t numDicts, then per dictionary: uint32_t numStrings, uint32_t size, nul terminated strings
+//     uint32_t numRowGroups, then per row group: uint64_t offset, uint32_t numRows
+//   trailer                                offset of the footer, footer magic
+//
+// Values are unsigned LEB128 varints. encDelta chunks hold the zigzag encoded difference from the previous
+// row (the first row of a chunk is relative to 0); encRunLength chunks hold value, count pairs. Dictionary
+// columns hold string index + 1, with 0 for no string. Fixed size fields are in host byte order; a header
+// version that reads as a huge number means the file came from a host of the other byte order
+
+#ifdef SWIG
+	%ignore ColTrace;
+	%ignore ColTraceWriter;
+	%ignore ColTraceReader;
+#endif // SWIG
+
+class ColTrace {
+public:
+	enum {
+		version = 1,
+		nameSize = 16,
+	};
+
+	enum column {
+		colPC = 0,
+		colCore,
+		colTimestamp,
+		colFunction,
+		colFile,
+		colLine,
+		colCRFlags,
+		colBrFlags,
+		numColumns
+	};
+
+	enum valueType {
+		typeU8 = 1,
+		typeU32 = 2,
+		typeU64 = 3,
+	};
+
+	enum encoding {
+		encDelta = 1,
+		encRunLength = 2,
+	};
+
+	enum dictionary {
+		dictNone = 0,
+		dictFunction = 1,
+		dictFile = 2,
+		numDicts = 2
+	};
+
+	struct header {
+		char     magic[8];		// "DQRCOL\0\0"
+		uint32_t version;
+		uint32_t numColumns;
+		uint32_t rowGroupSize;		// most rows in a row group
+		uint32_t reserved;
+	};
+
+	struct columnDesc {
+		char     name[nameSize];	// nul padded
+		uint8_t  type;			// valueType
+		uint8_t  encoding;
+		uint8_t  dict;			// dictionary, 1 based
+		uint8_t  reserved;
+	};
+
+	struct rowGroupHeader {
+		uint32_t numRows;
+	};
+
+	struct trailer {
+		uint64_t footerOffset;
+		char     magic[8];		// "DQRCOLFT"
+	};
+};
+
+// class ColTraceWriter: write decoded instructions to a columnar trace file. Rows are kept until a row group
+// is full, then each column is encoded and the group is written
+
+class ColTraceWriter {
+public:
+	ColTraceWriter();
+	~ColTraceWriter();
+
+	TraceDqr::DQErr open(const char *fileName,uint32_t rowGroupSize = defaultRowGroupSize);
+	TraceDqr::DQErr addInstruction(Instruction *instInfo,Source *srcInfo);
+	TraceDqr::DQErr close();
+
+	TraceDqr::DQErr getStatus() { return status; }
+
+private:
+	enum {
+		defaultRowGroupSize = 65536,
+	};
+
+	struct dict {
+		char     *strings;		// nul terminated, back to back
+		uint32_t  size;
+		uint32_t  allocSize;
+		uint32_t  numStrings;
+		uint32_t *hash;			// string offset + 1, open addressing
+		uint32_t  hashMask;
+		uint32_t *offsets;		// string offset by index
+		uint32_t  offsetsSize;
+	};
+
+	TraceDqr::DQErr status;
+
+	FILE     *file;
+	char     *fileName;
+	uint64_t  offset;
+
+	uint32_t  rowGroupSize;
+	uint32_t  numRows;
+	uint64_t *values[ColTrace::numColumns];
+	uint8_t  *encodeBuffer;
+
+	uint64_t *rowGroupOffsets;
+	uint32_t *rowGroupRows;
+	uint32_t  numRowGroups;
+	uint32_t  rowGroupsSize;
+
+	dict      dicts[ColTrace::numDicts];
+
+	void cleanUp();
+	TraceDqr::DQErr write(const void *data,uint64_t size);
+	TraceDqr::DQErr writeRowGroup();
+	uint32_t dictAdd(dict &d,const char *s);
+};
+
+// class ColTraceReader: map a columnar trace file. readColumn() decodes one column of one row group
+
+class ColTraceReader {
+public:
+	ColTraceReader();
+	~ColTraceReader();
+
+	TraceDqr::DQErr open(const char *fileName);
+	TraceDqr::DQErr getStatus() { return status; }
+
+	int         getNumColumns() { return numColumns; }
+	const char *getColumnName(int col);
+	int         findColumn(const char *name);
+	bool        isDictColumn(int col) { return (col >= 0) && (col < numColumns) && (columns[col].dict != ColTrace::dictNone); }
+
+	uint32_t getNumRowGroups() { return numRowGroups; }
+	uint32_t getRowGroupRows(uint32_t rowGroup);
+	uint64_t getNumRows() { return numRows; }
+
+	TraceDqr::DQErr readColumn(uint32_t rowGroup,int col,uint64_t *values);
+	const char *getDictString(int col,uint64_t value);
+
+private:
+	TraceDqr::DQErr status;
+
+	class MappedFile           *file;
+	const ColTrace::columnDesc *columns;
+	int                         numColumns;
+	uint32_t                    numRowGroups;
+	const uint8_t              *rowGroupIndex;	// in the footer
+	uint64_t                    numRows;
+	uint32_t                    dictCount[ColTrace::numDicts];
+	const char                **dictStrings[ColTrace::numDicts];
+
+	void cleanUp();
+};
+
 #endif /* DQR_HPP_ */
@@ -14,8 +14,12 @@
 #include <cassert>
 #include <fcntl.h>
 #include <unistd.h>
+#include <mutex>
+#include <atomic>
+#include <new>
+#include <condition_variable>
+#include <thread>
 
-#ifdef DO_TIMES
 class Timer {
 public:
 	Timer();
@@ -27,17 +31,73 @@ public:
 private:
 	double startTime;
 };
-#endif // DO_TIMES
 
 void sanePath(TraceDqr::pathType pt,const char *src,char *dst);
 
+// runJobs(): call doJob(context,j) for each j from 0 to numJobs-1, using up to one thread per hardware thread.
+// The calling thread is one of the workers, so all jobs are still run if no other threads can be started.
+// Returns when all jobs are done
+
+void runJobs(int numJobs,void (*doJob)(void *context,int job),void *context);
+
+// the library prints its error and info messages with printf(). They go to the calling thread's message file
+// instead of stdout if it has one (see Trace::setThreadMessageFile()), so the messages for a dqr -server request
+// are sent back to the client with the rest of its output. Must come after the system includes
+
+extern thread_local FILE *threadMsgFile;
+
+int dqrPrintf(const char *format,...) __attribute__ ((format (printf,1,2)));
+
+#define printf(...) dqrPrintf(__VA_ARGS__)
+
+// struct displaySettings: the address display settings and target frequency that Instruction and NexusMessage
+// keep in statics for the whole process. A thread that runs one of several decodes at the same time (dqr -batch
+// and -server) gets its own copy with Trace::setThreadDisplaySettings(). The library reads and writes these
+// settings through the functions below, which use the thread's copy if it has one
+
+struct displaySettings {
+	int      addrSize;
+	uint32_t addrDispFlags;
+	int      addrPrintWidth;
+	uint32_t targetFrequency;
+};
+
+extern thread_local displaySettings *threadDisplaySettings;
+
+inline int &dispAddrSize()
+{
+	return (threadDisplaySettings != nullptr) ? threadDisplaySettings->addrSize : Instruction::addrSize;
+}
+
+inline uint32_t &dispAddrDispFlags()
+{
+	return (threadDisplaySettings != nullptr) ? threadDisplaySettings->addrDispFlags : Instruction::addrDispFlags;
+}
+
+inline int &dispAddrPrintWidth()
+{
+	return (threadDisplaySettings != nullptr) ? threadDisplaySettings->addrPrintWidth : Instruction::addrPrintWidth;
+}
+
+inline uint32_t &dispTargetFrequency()
+{
+	return (threadDisplaySettings != nullptr) ? threadDisplaySettings->targetFrequency : NexusMessage::targetFrequency;
+}
+
+// class cachedInstInfo: the results of Disassembler::disassemble() for one address. The text and names
+// point into the section, symbol table, and file reader, and are not copied. An entry with an instsize
+// of 0 is empty
+
 class cachedInstInfo {
 public:
-	cachedInstInfo(const char *file,int cutPathIndex,const char *func,int linenum,const char *lineTxt,const char *instText,TraceDqr::RV_INST inst,int instSize,const char *addresslabel,int addresslabeloffset);
+	cachedInstInfo();
+	cachedInstInfo(TraceDqr::ADDRESS addr,const char *file,int cutPathIndex,const char *func,int linenum,const char *lineTxt,char *instText,TraceDqr::RV_INST inst,int instSize,const char *addresslabel,int addresslabeloffset);
 	~cachedInstInfo();
 
 	void dump();
 
+	TraceDqr::ADDRESS address;
+
 	const char *filename;
 	int         cutPathIndex;
 	const char *functionname;
@@ -53,15 +113,58 @@ public:
 	int               addressLabelOffset;
 };
 
-// class Section: work with elf file sections
+// class Arena: append only storage for many small objects and strings, carved out of large blocks instead of
+// allocating each one. Nothing is freed until the arena is deleted, which frees the blocks and not the objects,
+// so only objects that need no destructor go in an arena. intern() keeps one copy of each distinct string.
+// An arena is not thread safe; threads that load in parallel use their own arena and merge it afterwards
 
-class SrcFile {
+class Arena {
 public:
-	SrcFile(char *fName,SrcFile *nxt);
-	~SrcFile();
+	Arena();
+	~Arena();
+
+	void *alloc(size_t size);
+	template <typename T> T *allocObj() { void *p = alloc(sizeof(T)); return (p == nullptr) ? nullptr : new (p) T(); }
+	char *add(const char *s);
+	char *intern(const char *s,bool *added = nullptr);
+	void merge(Arena &from);
+
+	uint32_t getNumInterned() { return numInterned; }
+
+	static uint32_t hashString(const char *s);
+
+private:
+	enum {
+		blockSize = 64*1024,
+		bigAlloc = blockSize/4,	// allocations larger than this get a block of their own
+		internTableInitialSize = 256,
+	};
+
+	struct arenaBlock {
+		arenaBlock *next;
+		size_t      size;
+		size_t      used;
+		size_t      pad;	// keeps the data that follows the header 16 byte aligned
+	};
+
+	arenaBlock *blocks;	// block being carved is first
 
-	class SrcFile *next;
-	char *file;
+	char     **internTable;	// open addressing, nullptr for an empty slot
+	uint32_t   internTableSize;	// power of 2
+	uint32_t   numInterned;
+
+	char **findInterned(const char *s,uint32_t hash);
+	bool growInternTable();
+};
+
+// class Section: work with elf file sections
+
+// class SrcFileRoot: the source file names of an ElfReader. Each name is kept once, so line info and syms
+// from any number of elf files can compare file names by pointer
+
+struct SrcFile {
+	SrcFile *next;
+	char    *file;
 };
 
 class SrcFileRoot {
@@ -70,10 +173,25 @@ public:
 	~SrcFileRoot();
 
 	char *addFile(char *fName);
+	void merge(SrcFileRoot &from);
 	void dump();
 
 private:
 	SrcFile *fileRoot;
+	Arena    names;	// holds the SrcFile list and the names
+};
+
+// struct predecodedInst: per halfword decode results for a code section, built when the ElfReader is sealed
+
+struct predecodedInst {
+	uint8_t inst_size;	// 0 if the halfword does not start an instruction that can be decoded
+	uint8_t inst_type;
+	int8_t  rs1;
+	int8_t  rd;
+	uint8_t crFlag;		// crFlag and brFlag as computed by getCRBRFlags() for an inferable call
+	uint8_t brFlag;
+	uint8_t is_branch;
+	int32_t immediate;	// static target delta for jumps and branches
 };
 
 //class spSym {
@@ -102,14 +220,35 @@ public:
 		sect_OCTETS = 1 << 8
 	};
 
+	// a run of halfwords with the same source file and line. A run ends where the next one starts, or at
+	// the end of the section. Halfwords without line information are in runs with a null fName
+
+	struct lineRun {
+		uint32_t index;
+		uint32_t line;
+		char    *fName;
+	};
+
 	Section();
    ~Section();
 
 	Section *getSectionByAddress(TraceDqr::ADDRESS addr);
 	Section *getSectionByName(char *secName);
 
-	cachedInstInfo *setCachedInfo(TraceDqr::ADDRESS addr,const char *file,int cutPathIndex,const char *func,int linenum,const char *lineTxt,const char *instTxt,TraceDqr::RV_INST inst,int instSize,const char *addresslabel,int addresslabeloffset);
-	cachedInstInfo *getCachedInfo(TraceDqr::ADDRESS addr);
+	TraceDqr::DQErr setLines(uint32_t index,uint32_t count,char *fName,uint32_t line);
+	TraceDqr::DQErr fillLines(uint32_t index,uint32_t count,char *fName,uint32_t line);
+	void getLine(uint32_t index,char *&fName,uint32_t &line);
+	uint32_t getNumLineRuns() { return numLineRuns; }
+	const lineRun *getLineRuns() { return lineRuns; }
+
+	TraceDqr::DQErr allocDiss();
+	bool haveDiss() { return dissPages != nullptr; }
+	char *getDiss(uint32_t index);
+	char *setDiss(uint32_t index,const char *text);
+
+	void predecode(int archSize);
+
+	void setView(Section *imageSection,TraceDqr::ADDRESS vma_offset);
 
 	void dump();
 
@@ -125,9 +264,6 @@ public:
 //	spSym       *spSymsRoot;
 //	spSyms     **spSymIndex; sorted array of pointer to spSyms for this section
 	uint16_t    *code;
-	char       **fName;  // file name - array of pointers
-	uint32_t    *line;   // line number array
-	char       **diss;   // disassembly text - array of pointers
 //	uint8_t     *dissFlags; // only needed for linux dynamic lib decode - maybe don't need
 
 //if static-linked file, vma-offset = 0, objdump vma-offset - not used
@@ -137,10 +273,135 @@ public:
 //control transfer instruciton need address modified for destination when doing vma-offset and dissed at offset 0
 //also, lds and stores need stuff modified??
 
-	cachedInstInfo **cachedInfo; // array of pointers
+	predecodedInst *predecoded; // array of size/2 decode results, or nullptr if not predecoded
+
+	// a view of a section in a LibImage shares the code, line, disassembly, and predecode tables of the
+	// image section, and only has its own vmaOffset. image is nullptr for sections that own their tables
+
+	Section     *image;
+
+	// code and predecoded point into a mapped elf disk cache file (see ElfDiskCache::load()) and are not
+	// deleted with the section
+
+	bool         mapped;
+
+private:
+	enum {
+		dissPageShift = 9,	// halfwords per page of disassembly text pointers is 1 << dissPageShift
+	};
+
+	lineRun     *lineRuns;	// sorted by index, and the first run starts at index 0
+	uint32_t     numLineRuns;
+	uint32_t     maxLineRuns;
+
+	// disassembly text, one pointer per halfword. The pages of pointers are only allocated when text is
+	// set for a halfword in them, and the text is interned in dissPool. Readers do not lock; text is only
+	// added (never changed) under dissLock, because sections may be shared by several threads (see ElfCache)
+
+	std::atomic<std::atomic<char*>*> *dissPages;
+	uint32_t     numDissPages;
+	Arena        dissPool;
+	std::mutex   dissLock;
+
+	int findLineRun(uint32_t index);
+	TraceDqr::DQErr growLineRuns(uint32_t n);
 };
 
-// class fileReader: Helper class to handler list of source code files
+// class SectionIndex: sorted, non-overlapping address ranges over a list of sections, for O(log n) section
+// lookups by address. Where sections overlap, the range goes to the section added last (build() adds a list
+// from the end, so the first section in the list wins, the same as Section::getSectionByAddress()). Lookups
+// do not write to the index; callers keep their own last hit
+
+class SectionIndex {
+public:
+	SectionIndex();
+	~SectionIndex();
+
+	TraceDqr::DQErr build(Section *sectionLst,bool inclusiveEnd);
+	TraceDqr::DQErr add(Section *sp);
+
+	Section *lookup(TraceDqr::ADDRESS addr);
+	Section *lookup(TraceDqr::ADDRESS addr,int &lastHit);
+
+private:
+	struct sectionRange {
+		TraceDqr::ADDRESS first;
+		TraceDqr::ADDRESS last;	// inclusive
+		Section          *section;
+	};
+
+	bool          inclusiveEnd;	// section endAddr is the last address in the section, not one past it
+	int           numRanges;
+	int           maxRanges;
+	sectionRange *ranges;
+
+	int findRange(TraceDqr::ADDRESS addr);
+};
+
+// class SrcTreeIndex: the files under a source root (the new root of -cutpath), found with one walk of the
+// tree the first time a name is resolved. A name is resolved to the file whose path relative to the root
+// ends with all the path components of the name, so a file that is deeper in the tree is still found.
+// Results, including misses, are remembered. There is one index per root, shared by every fileReader and
+// safe to use from several threads. If an index file is set, the walk is saved to it and later runs for
+// the same root read it instead of walking the tree. Not used unless enabled
+
+class SrcTreeIndex {
+public:
+	static SrcTreeIndex *getIndex(const char *root);
+	static void setEnable(bool enable) { enabled = enable; }
+	static void setIndexFile(const char *file);
+
+	TraceDqr::DQErr resolve(const char *name,const char *&localName);
+
+private:
+	enum {
+		tableInitialSize = 256,
+		maxPath = 4096,
+	};
+
+	struct resolved {
+		char       *name;
+		const char *localName;	// nullptr if not found
+	};
+
+	SrcTreeIndex(const char *root);
+
+	static bool          enabled;
+	static std::mutex    indexesLock;
+	static SrcTreeIndex *indexes;
+	static char         *indexFile;
+
+	SrcTreeIndex *next;
+	char         *root;
+	std::mutex    lock;
+	TraceDqr::DQErr status;	// DQERR_ERR if the tree could not be indexed
+	bool          indexed;
+
+	uint32_t      numFiles;
+	char        **files;	// paths relative to root, sorted
+	int          *nextSameBase;	// next file with the same base name, or -1
+	int          *baseTable;	// first file for a base name, open addressing, -1 for an empty slot
+	uint32_t      baseTableSize;	// power of 2
+
+	resolved     *resolvedTable;	// open addressing, name is nullptr for an empty slot
+	uint32_t      resolvedTableSize;	// power of 2
+	uint32_t      numResolved;
+
+	Arena         arena;	// holds the paths and names
+
+	TraceDqr::DQErr build();
+	TraceDqr::DQErr walk(char *path,int rootLen,int len,char **&fileLst,uint32_t &fileLstSize);
+	TraceDqr::DQErr readIndexFile(char **&fileLst,uint32_t &fileLstSize);
+	void writeIndexFile();
+	TraceDqr::DQErr addFile(const char *relPath,char **&fileLst,uint32_t &fileLstSize);
+	const char *findFile(const char *name);
+	resolved *findResolved(const char *name);
+	bool growResolvedTable();
+};
+
+// class fileReader: Helper class to handler list of source code files. Source files are mapped, not read,
+// and the line index for a file is built the first time one of its lines is asked for. Only the lines
+// asked for are copied (to nul terminate them)
 
 class fileReader {
 public:
@@ -153,8 +414,10 @@ public:
 		char         *name;
 		int           cutPathIndex;
 		funcList     *funcs;
-		unsigned int  lineCount;
-		char        **lines;
+		class MappedFile *text;		// nullptr if the file could not be read
+		unsigned int  lineCount;	// valid once lineStarts is built
+		uint32_t     *lineStarts;	// offset of each line in text, nullptr until built
+		char        **lines;		// nul terminated copies of the lines asked for so far
 	};
 
 	fileReader(/*paths?*/);
@@ -162,15 +425,29 @@ public:
 
 	TraceDqr::DQErr subSrcPath(const char *cutPath,const char *newRoot);
 	fileList *findFile(const char *file);
+	char *addFunction(fileList *fl,const char *function);
+	const char *getLine(fileList *fl,unsigned int line);
 
 private:
+	enum {
+		fileTableInitialSize = 64,
+	};
+
 	char *cutPath;
 	char *newRoot;
+	SrcTreeIndex *srcTree;	// index of newRoot, or nullptr
 
 	fileList *readFile(const char *file);
+	bool buildLineIndex(fileList *fl);
+	fileList **findSlot(const char *file);
+	bool growFileTable();
 
 	fileList *lastFile;
 	fileList *files;
+	fileList **fileTable;	// files hashed by name, open addressing, nullptr for an empty slot
+	uint32_t   fileTableSize;	// power of 2
+	uint32_t   numFiles;
+	Arena     arena;	// holds the file and function lists, the names, the line indexes and the line copies
 };
 
 // class Symtab: Interface class between bfd symbols and what is needed for dqr
@@ -201,38 +478,57 @@ struct Sym {
 	struct Sym *srcFile;
 };
 
+// struct symRange: a range of addresses that all look up to the same symbol (or to no symbol if sym is null).
+// Returned by Symtab lookups so callers can keep their own caches; lookups do not write to the Symtab, which
+// may be shared between threads
+
+struct symRange {
+	TraceDqr::ADDRESS lo;	// first address in the range
+	TraceDqr::ADDRESS hi;	// last address in the range + 1
+	Sym              *sym;
+};
+
 class Symtab {
 public:
-	Symtab(Sym *syms);
+	Symtab(Sym *syms,bool sorted = false);	// sorted: syms are already in address order with sizes fixed up (elf disk cache)
 	~Symtab();
-	TraceDqr::DQErr lookupSymbolByAddress(TraceDqr::ADDRESS addr,Sym *&sym);
+	TraceDqr::DQErr lookupSymbolByAddress(TraceDqr::ADDRESS addr,Sym *&sym,symRange *range = nullptr);
 	void dump();
 
+	long getNumSyms() { return numSyms; }
+	Sym *getSortedSym(long index) { return symPtrArray[index]; }
+
 	TraceDqr::DQErr getStatus() { return status; }
 
 private:
 	TraceDqr::DQErr status;
 
-	TraceDqr::ADDRESS cachedSymAddr;
-	int cachedSymSize;
-	int cachedSymIndex;
 	long      numSyms;
 	Sym      *symLst;
 	Sym     **symPtrArray;
+	uint64_t *symEndArray;	// symEndArray[i] is the largest end address of symPtrArray[0] to symPtrArray[i], or nullptr
+				// if lookups must scan symPtrArray (addresses that wrap, or that are not in increasing order)
 
 	TraceDqr::DQErr fixupFunctionSizes();
+	void buildEndArray();
 };
 
 class ObjDump {
 public:
-	ObjDump(const char *elfName,const char* objdumpPath,uint64_t vmaOffset,int &archSize,Section *&codeSectionLst,Sym *&syms,SrcFileRoot &srcFileRoot);
+	ObjDump(const char *elfName,const char* objdumpPath,uint64_t vmaOffset,int &archSize,Section *&codeSectionLst,Sym *&syms,Arena &arena,SrcFileRoot &srcFileRoot);
 	ObjDump(const char *blobName,const char* objdumpPath,TraceDqr::ADDRESS startAddr,TraceDqr::ADDRESS endAddr,int archSize,Section *&codeSectionLst);
 
 	~ObjDump();
 
 	TraceDqr::DQErr getStatus() {return status;}
 
+	static TraceDqr::DQErr benchmark(const char *odTextName);
+
 private:
+	enum {
+		pipeBufferSize = 1024*1024,
+	};
+
 	enum objDumpTokenType {
 	    odtt_error,
 	    odtt_eol,
@@ -260,7 +556,7 @@ private:
 	FILE *fpipe;
 
 	bool pipeEOF;
-	char pipeBuffer[2048];
+	char *pipeBuffer;	// pipeBufferSize chars plus a '\n' sentinel stored at pipeBuffer[endOfBuffer]
 	int  pipeIndex = 0;
 	int  endOfBuffer = 0;
 
@@ -268,6 +564,8 @@ private:
 //	TraceDqr::ADDRESS startAddr;
 	TraceDqr::elfType eType;
 
+	ObjDump(const char *odTextName);
+
 	TraceDqr::DQErr execObjDump(const char *elfName,TraceDqr::elfType eType,uint64_t vmaOffset,const char *objdumpPath);
 	TraceDqr::DQErr fillPipeBuffer();
 	objDumpTokenType getNextLex(char *lex);
@@ -284,9 +582,99 @@ private:
 	TraceDqr::DQErr parseDisassemblyList(objDumpTokenType &nextType,char *nextLex,Section *codeSectionLst,SrcFileRoot &srcFileRoot,uint64_t startAddr);
 	TraceDqr::DQErr parseFixedField(uint32_t &flags);
 	TraceDqr::DQErr parseSymbol(bool &haveSym,char *secName,char *symName,uint32_t &symFlags,uint64_t &symSize);
-	TraceDqr::DQErr parseSymbolTable(objDumpTokenType &nextType,char *nextLex,Sym *&syms,Section *&codeSectionLst,uint64_t vmaOffset);
+	TraceDqr::DQErr parseSymbolTable(objDumpTokenType &nextType,char *nextLex,Sym *&syms,Arena &arena,Section *&codeSectionLst,uint64_t vmaOffset);
 	TraceDqr::DQErr parseElfName(char *elfName,TraceDqr::elfType &et);
-	TraceDqr::DQErr parseObjDump(int &archSize,Section *&codeSectionLst,Sym *&symLst,SrcFileRoot &srcFileRoot,uint64_t vmaOffset,uint64_t startAddr,uint64_t endAddr);
+	TraceDqr::DQErr parseObjDump(int &archSize,Section *&codeSectionLst,Sym *&symLst,Arena &arena,SrcFileRoot &srcFileRoot,uint64_t vmaOffset,uint64_t startAddr,uint64_t endAddr);
+};
+
+// class MappedFile: read only view of a whole file. The file is mapped if possible, otherwise it is read into
+// memory (windows). open() with quiet set does not print an error for a file that is not there
+
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	TraceDqr::DQErr open(const char *fileName,bool quiet = false);
+	void close();
+
+	const uint8_t *getData() { return data; }
+	uint64_t       getSize() { return size; }
+
+private:
+	const uint8_t *data;
+	uint64_t       size;
+	uint8_t       *buffer;	// data when the file was read instead of mapped
+	void          *mapAddr;
+};
+
+// class ElfLoader: read the section headers, symbol table, and .debug_line of an elf file directly
+// (without objdump), and build the same section list, syms, and source files ObjDump does. Disassembly
+// text (Section::diss) is left empty and generated by the Disassembler when it is needed. Binary blobs
+// are read the same way. If the file can't be handled here, status is DQERR_ERR and nothing is added to
+// the lists, so the caller can use ObjDump instead
+
+class ElfLoader {
+public:
+	ElfLoader(const char *elfName,uint64_t vmaOffset,int &archSize,Section *&codeSectionLst,Sym *&syms,Arena &arena,SrcFileRoot &srcFileRoot);
+	ElfLoader(const char *blobName,TraceDqr::ADDRESS startAddr,TraceDqr::ADDRESS endAddr,Section *&codeSectionLst);
+	ElfLoader(const char *const *blobNames,int numBlobs,TraceDqr::ADDRESS startAddr,uint32_t blobSize,Section *&codeSectionLst);
+	~ElfLoader();
+
+	TraceDqr::DQErr getStatus() {return status;}
+
+private:
+	struct elfSection {
+		const char *name;
+		uint32_t    type;
+		uint64_t    flags;
+		uint64_t    addr;
+		uint64_t    offset;
+		uint64_t    size;
+		uint32_t    link;
+		uint64_t    addralign;
+		uint64_t    entsize;
+		Section    *sp;		// code or .comment section created for this section, or nullptr
+	};
+
+	struct compDir {
+		uint64_t    stmtList;	// offset of the line table in .debug_line
+		const char *dir;
+	};
+
+	TraceDqr::DQErr status;
+
+	MappedFile     mappedFile;
+	const uint8_t *image;
+	uint64_t       imageSize;
+
+	bool         is64;
+	int          numSections;
+	elfSection  *sections;
+	Section     *lastSection;	// last code section a line table row was added to
+
+	int          numCompDirs;
+	compDir     *compDirs;
+
+	const uint8_t *debugStr;
+	uint64_t       debugStrSize;
+	const uint8_t *debugLineStr;
+	uint64_t       debugLineStrSize;
+
+	static int compDirCompareFunc(const void *arg1,const void *arg2);
+
+	TraceDqr::DQErr loadFile(const char *elfName);
+	Section *newBlobSection(TraceDqr::ADDRESS startAddr,TraceDqr::ADDRESS endAddr);
+	void copyBlob(Section *sp,uint64_t offset,uint64_t size);
+	TraceDqr::DQErr readSectionHeaders();
+	elfSection *findSection(const char *name);
+	TraceDqr::DQErr buildSections(uint64_t vmaOffset,Section *&sectionLst);
+	TraceDqr::DQErr readSymbols(uint64_t vmaOffset,Sym *&symLst,Arena &arena);
+	TraceDqr::DQErr readCompDirs();
+	const char *getDwarfString(uint64_t form,const uint8_t *&p,const uint8_t *end,int addrSize,bool dwarf64);
+	TraceDqr::DQErr readLineTables(Section *sectionLst,SrcFileRoot &srcFileRoot);
+	TraceDqr::DQErr readLineTable(const uint8_t *&p,const uint8_t *end,uint64_t stmtList,Section *sectionLst,SrcFileRoot &srcFileRoot);
+	void addLineRange(Section *sectionLst,uint64_t startAddr,uint64_t endAddr,char *fName,uint32_t line);
 };
 
 class process {
@@ -296,13 +684,56 @@ public:
 
   int pid;
   char *elfName;
+  char *mapFileName; // linux traces: the mapping file the process is built from (see ProcessLoader)
   class ElfReader *elfReader;
+  bool sharedElfReader; // elfReader belongs to the elf cache
   class Disassembler *disassembler;
   class EventConverter  *eventConverter;
   class CTFConverter *ctf;
   class PerfConverter *perfConverter;
 };
 
+// class ProcessLoader: builds the processes of a linux trace the first time their pid shows up, instead of
+// building every process in the mapping file list when the trace is configured. A prescan thread reads ahead
+// in the trace file for context changes and builds each process it finds a pid for, so it is usually ready
+// before the decoder gets there. Processes are only installed in the Trace object (and given the current path
+// settings) by getProcess(), on the decoding thread
+
+class ProcessLoader {
+public:
+	ProcessLoader(class Trace *trace,const char *tfName,int srcBits);
+	~ProcessLoader();
+
+	TraceDqr::DQErr getStatus() { return status; }
+
+	TraceDqr::DQErr getProcess(int processIndex);
+
+private:
+	enum {
+		loadPending,
+		loadBuilding,
+		loadBuilt,
+		loadInstalled,
+		loadFailed
+	};
+
+	TraceDqr::DQErr         status;
+	class Trace            *trace;
+	int                     numProcesses;
+	int                    *state;	// one of the enums above for each process
+	process                *built;	// processes built, but not yet installed in the Trace object
+	std::mutex              loadLock;
+	std::condition_variable loadCond;
+	std::atomic<bool>       stopPrescan;
+	std::atomic<int>        numPending;	// processes still loadPending; prescan stops when there are none
+	std::thread             prescanThread;
+
+	void build(std::unique_lock<std::mutex> &lk,int processIndex);
+	TraceDqr::DQErr install(int processIndex);
+	void prescanPid(int pid);
+	static void prescan(ProcessLoader *loader,char *tfName,int srcBits);
+};
+
 class addressMap {
 public:
   addressMap(const char *name,TraceDqr::elfType e_type,bool is_blob,uint64_t start,uint64_t end);
@@ -319,38 +750,209 @@ class ElfReader {
 public:
 	ElfReader(const char *elfname,const char *odExe,uint64_t vma_offset);
 	TraceDqr::DQErr addElfFile(const char *elfname,addressMap *addrMap,const char *odExe);
+	TraceDqr::DQErr addElfFiles(addressMap *addrMapLst,const char *odExe);
 
 	~ElfReader();
 	TraceDqr::DQErr getStatus() { return status; }
         TraceDqr::DQErr addElfFile(const char *elfname,const char *odExe);
 	TraceDqr::DQErr getInstructionByAddress(TraceDqr::ADDRESS addr, TraceDqr::RV_INST &inst);
+	TraceDqr::DQErr getInstructionByAddress(TraceDqr::ADDRESS addr, TraceDqr::RV_INST &inst,int &sectionHint);
 	Symtab    *getSymtab();
 	Section   *getSections() { return codeSectionLst; }
+	SectionIndex *getSectionIndex() { return sectionIndex; }	// nullptr until sealed
 	int        getArchSize() { return archSize; }
 	int        getBitsPerAddress() { return bitsPerAddress; }
 	const char *getElfName();
 
 	TraceDqr::DQErr parseNLSStrings(TraceDqr::nlStrings *nlsStrings);
 
-	TraceDqr::DQErr seal();
+	TraceDqr::DQErr seal(uint64_t predecodeLimit);
+	const predecodedInst *getPredecodedInstByAddress(TraceDqr::ADDRESS addr);
+	const predecodedInst *getPredecodedInstByAddress(TraceDqr::ADDRESS addr,int &sectionHint);
+	uint64_t   getPredecodeSize() { return predecodeSize; }
 
 	TraceDqr::DQErr dumpSyms();
 
+	static void setNativeLoader(bool enable) { nativeLoader = enable; }
+	static bool getNativeLoader() { return nativeLoader; }
+	static void setReportLoadTimes(bool enable) { reportLoadTimes = enable; }
+
 private:
+	static bool nativeLoader;	// read elf files with ElfLoader, using ObjDump only if that fails
+	static bool reportLoadTimes;	// print how long each elf file took to load
+
 	TraceDqr::DQErr  status;
 	bool        sealed;
+	bool        fromDiskCache;	// sections and syms were read from the elf disk cache (syms are sorted)
+	class ElfDiskCache *diskCache;	// cache to write when sealed, or nullptr
+	MappedFile  diskCacheFile;	// the elf disk cache file the sections were read from; their code and predecode tables are in it
 	char       *elfName;
 	int         archSize;
 	int         bitsPerAddress;
 	Section	   *codeSectionLst;
 	Sym        *symLst;
 	Symtab     *symtab;
+	SectionIndex *sectionIndex;
+	Arena       arena;	// holds the syms and their names
 	SrcFileRoot srcFileRoot;
+	uint64_t    predecodeSize;
 
 //	TraceDqr::DQErr addSections(Section *sections);
-	TraceDqr::DQErr fixupSourceFiles(Sym *syms);
+	struct libImageRef {
+		libImageRef     *next;
+		class LibImage  *image;
+	};
+
+	libImageRef *libImages;	// shared library images the views in codeSectionLst belong to (see LibImageCache)
+
+	static TraceDqr::DQErr fixupSourceFiles(Sym *syms);
+	TraceDqr::DQErr predecodeSections(uint64_t predecodeLimit);
+	TraceDqr::DQErr addLibImage(class LibImage *image);
+
+	static TraceDqr::DQErr loadElfFile(const char *elfname,addressMap *addrMap,const char *odExe,int &archSize,Section *&codeSectionLst,Sym *&symLst,Arena &arena,SrcFileRoot &srcFileRoot,class LibImage **image);
+	static void loadElfFileJob(void *jobs,int i);
+
+	friend class LibImage;
 };
 
+// class ElfDiskCache: a file per elf file in the cache directory that holds the sealed state of an ElfReader
+// (sections with code, line, file and disassembly tables, predecode tables, and the sorted symbols), so later
+// runs map the file instead of reading the elf file or running objdump. The file is named from the elf build-id
+// (or a hash of the elf file if it has none), the decoder version, the vma offset, and the loader used. All
+// references in the file are offsets, so it can be mapped anywhere. The code and predecode tables are used in
+// place from the mapped file, which the ElfReader keeps open. Disabled unless a cache directory is set
+
+class ElfDiskCache {
+public:
+	ElfDiskCache(const char *elfName,uint64_t vmaOffset,bool nativeLoader);
+	~ElfDiskCache();
+
+	TraceDqr::DQErr getStatus() { return status; }
+
+	TraceDqr::DQErr load(MappedFile &file,int &archSize,Section *&codeSectionLst,Sym *&syms,Arena &arena,SrcFileRoot &srcFileRoot);
+	TraceDqr::DQErr save(int archSize,Section *codeSectionLst,Symtab *symtab);
+
+	static void setCacheDir(const char *dir);
+	static const char *getCacheDir() { return cacheDir; }
+
+private:
+	static char *cacheDir;
+
+	TraceDqr::DQErr status;
+	char           *cacheName;
+	uint64_t        key;
+	uint64_t        vmaOffset;
+	bool            nativeLoader;
+};
+
+// class ElfCache: sealed ElfReader objects shared by Trace objects, so decoding many traces of the
+// same elf file only runs objdump once. A sealed ElfReader is only read from, so it can be used by
+// Trace objects on different threads
+
+class ElfCache {
+public:
+	ElfCache();
+	~ElfCache();
+
+	void setEnable(bool enable);
+	bool isEnabled() { return enabled; }
+
+	ElfReader *getElfReader(const char *elfName,const char *odExe,uint64_t predecodeLimit);
+	void releaseElfReader(ElfReader *elfReader);
+
+private:
+	enum {
+		maxUnused = 16,	// elf files kept loaded while not in use
+	};
+
+	struct elfCacheEntry {
+		elfCacheEntry *next;
+		char          *elfName;
+		char          *odName;
+		uint64_t       predecodeLimit;
+		bool           nativeLoader;
+		int64_t        size;
+		int64_t        mtime;
+		bool           ready;	// elfReader has been created; entries whose read failed are removed
+		int            refCount;
+		ElfReader     *elfReader;
+	};
+
+	bool                    enabled;
+	std::mutex              cacheLock;
+	std::condition_variable readyCond;
+	elfCacheEntry          *entries;	// most recently used first
+
+	void flush();
+	void trim();
+};
+
+extern ElfCache elfCache;
+
+// class LibImage: a shared library read once at vma offset 0. Each process that maps the library gets views
+// of its sections and a copy of its syms with the vma offset of the process filled in (the syms are copied
+// because Symtab fixes up their sizes). After it is loaded, an image only changes through the views, which
+// add disassembly text and predecode tables under the image section locks
+
+class LibImage {
+public:
+	LibImage(const char *elfName,const char *odExe);
+	~LibImage();
+
+	TraceDqr::DQErr getStatus() { return status; }
+
+	TraceDqr::DQErr addView(uint64_t vmaOffset,int &archSize,Section *&codeSectionLst,Sym *&symLst,Arena &symArena);
+
+private:
+	TraceDqr::DQErr status;
+	int             archSize;
+	Section        *codeSectionLst;
+	Section       **sections;	// codeSectionLst in list order, numSections entries
+	int             numSections;
+	Sym            *syms;		// the syms in list order, numSyms entries. srcFile fields point into the array
+	int             numSyms;
+	Arena           arena;
+	SrcFileRoot     srcFileRoot;
+};
+
+// class LibImageCache: the LibImage objects for the shared libraries of linux traces, so a library mapped by
+// several processes is read (and disassembled and predecoded) once. Images are keyed by file name, objdump,
+// loader, and the size and modification time of the file. Enabled by default
+
+class LibImageCache {
+public:
+	LibImageCache();
+	~LibImageCache();
+
+	void setEnable(bool enable);
+	bool isEnabled() { return enabled; }
+
+	LibImage *getImage(const char *elfName,const char *odExe);
+	void releaseImage(LibImage *image);
+
+private:
+	struct libImageEntry {
+		libImageEntry *next;
+		char          *elfName;
+		char          *odName;
+		bool           nativeLoader;
+		int64_t        size;
+		int64_t        mtime;
+		bool           ready;	// image has been loaded (nullptr if that failed)
+		int            refCount;
+		LibImage      *image;
+	};
+
+	bool                    enabled;
+	std::mutex              cacheLock;
+	std::condition_variable readyCond;
+	libImageEntry          *entries;
+
+	void flush();
+};
+
+extern LibImageCache libImageCache;
+
 class TsList {
 public:
 	TsList();
@@ -520,6 +1122,7 @@ public:
 	TraceDqr::DQErr propertyToArchSize(const char *value);
 	TraceDqr::DQErr propertyToTraceType(const char *value);
 	TraceDqr::DQErr propertyToTolerateErrors(const char *value);
+	TraceDqr::DQErr propertyToPredecodeLimit(const char *value);
 
 	bool tolerateErrors;
 	char *odName;
@@ -550,6 +1153,9 @@ public:
 	char *hostName;
 	bool filterControlEvents;
 	char *kmemPath;
+	uint32_t predecodeLimit; // in megabytes; 0 disables predecode tables
+
+	static uint32_t defaultPredecodeLimit;	// predecodeLimit when the settings don't give one
 
 	bool itcPerfEnable;
 	int itcPerfChannel;
@@ -757,6 +1363,40 @@ private:
 	TraceDqr::ADDRESS cntrAddress[DQR_MAXCORES];
 	uint64_t *lastCount[DQR_MAXCORES];
 
+	// output is collected per file and written when a buffer fills or the converter is deleted, because a
+	// perf trace is mostly short records (one per sample per counter) written to two files each
+
+	enum {
+		perfBuffSize = 64*1024,
+		fileInfoCacheSize = 1024,	// must be a power of 2
+		fileInfoMaxLen = 192,
+	};
+
+	struct perfBuffer {
+		char *buff;
+		int   len;
+	};
+
+	perfBuffer perfBuffs[pt_numPerfTypes];	// buffers for perfFDs[]
+	perfBuffer perfBuff;			// buffer for perfFD
+
+	// the " ffl:file:func:line" text of an address, so repeated samples at the same pc do not look up
+	// the source line and function name again. Direct mapped, allocated on first use
+
+	struct fileInfoEntry {
+		TraceDqr::ADDRESS addr;
+		int               core;
+		int               len;	// 0 for an empty entry
+		char              text[fileInfoMaxLen];
+	};
+
+	fileInfoEntry *fileInfoCache;
+	char           fileInfoBuff[512];	// text too long for the cache
+
+	void perfWrite(int fd,perfBuffer &pb,const char *data,int len);
+	void perfFlush(int fd,perfBuffer &pb);
+	TraceDqr::DQErr getFileInfo(int core,TraceDqr::ADDRESS addr,const char *&text,int &len);
+
 	TraceDqr::DQErr emitPerfAddr(int core,TraceDqr::TIMESTAMP ts,TraceDqr::ADDRESS pc);
 	TraceDqr::DQErr emitPerfFnEntry(int core,TraceDqr::TIMESTAMP ts,TraceDqr::ADDRESS fnAddr,TraceDqr::ADDRESS callSite);
 	TraceDqr::DQErr emitPerfFnExit(int core,TraceDqr::TIMESTAMP ts,TraceDqr::ADDRESS fnAddr,TraceDqr::ADDRESS callSite);
@@ -803,6 +1443,9 @@ private:
 	const char *getControlText(int control);
 };
 
+// class KMem: kernel memory, read from the kmem.0x<address> page files in the kmem directory as the trace
+// reaches them. Runs of adjacent page files are read at once into one section
+
 class KMem {
 public:
 	KMem(const char *kmem_path,TraceDqr::ADDRESS start_address,int archsize,const char *obj_dump);
@@ -814,7 +1457,19 @@ public:
 	TraceDqr::DQErr getInstructionByAddress(TraceDqr::ADDRESS addr, TraceDqr::RV_INST &inst);
 	Source getSrcInfo() { return sourceInfo; };
 	Instruction getInstructionInfo() { return instructionInfo; };
+	TraceDqr::DQErr prewarm();
+
+	static void setPrewarm(bool enable) { prewarmPages = enable; }
+	static bool getPrewarm() { return prewarmPages; }
+
 private:
+	enum {
+		pageSize = 4096,
+		maxRangePages = 256,	// most pages read into one section
+	};
+
+	static bool prewarmPages;	// read every page in the kmem directory when the trace is configured
+
 	TraceDqr::DQErr status;
 
 	char *kMemPath;
@@ -826,27 +1481,52 @@ private:
         Source           sourceInfo;
 
 	Section *sectionLst;
-	Section *cachedSection;
+	SectionIndex sectionIndex;
+	int      sectionHint;	// last hit in sectionIndex
 
 	Section *findSection(TraceDqr::ADDRESS addr);
+	bool pageExists(TraceDqr::ADDRESS pageAddr);
+	TraceDqr::DQErr readRange(TraceDqr::ADDRESS addr);
+	TraceDqr::DQErr indexSections(Section *oldSectionLst);
+
+	static void getPageName(const char *kMemPath,TraceDqr::ADDRESS pageAddr,char *name,int size);
+	static TraceDqr::DQErr loadRange(const char *kMemPath,const char *objDump,int archSize,TraceDqr::ADDRESS rangeAddr,int numPages,Section *&sectionLst);
+	static void loadRangeJob(void *jobs,int i);
+};
+
+// struct decodeTableEntry: one precomputed decodeInstruction() result for the decode lookup tables
+
+struct decodeTableEntry {
+	uint8_t useSwitch;	// result depends on more bits than the table index; use the switch decoder
+	uint8_t inst_size;
+	uint8_t inst_type;
+	int8_t  rs1;
+	int8_t  rd;
+	uint8_t is_branch;
+	int16_t immediate;
 };
 
 // class Disassembler: class to help in the dissasemblhy of instrucitons
 
 class Disassembler {
 public:
-	 Disassembler(Symtab *stp,Section *sp,int archsize);
+	 Disassembler(Symtab *stp,Section *sp,SectionIndex *sip,int archsize);
 	 Disassembler(int archsize);
 	~Disassembler();
 
-    TraceDqr::DQErr disassemble(TraceDqr::ADDRESS addr);
+    TraceDqr::DQErr disassemble(TraceDqr::ADDRESS addr,int core);
 
-    TraceDqr::DQErr getSrcLines(TraceDqr::ADDRESS addr,const char **filename,int *cutPathIndex,const char **functionname,unsigned int *linenumber,const char **lineptr);
+    TraceDqr::DQErr getSrcLines(TraceDqr::ADDRESS addr,const char **filename,int *cutPathIndex,const char **functionname,unsigned int *linenumber,const char **lineptr,int core);
 
-	TraceDqr::DQErr getFunctionName(TraceDqr::ADDRESS addr,const char *&function,int &offset);
+	TraceDqr::DQErr getFunctionName(TraceDqr::ADDRESS addr,const char *&function,int &offset,int core);
 
 	static TraceDqr::DQErr   decodeInstructionSize(uint32_t inst, int &inst_size);
-	static int   decodeInstruction(uint32_t instruction,int archSize,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
+	static inline int decodeInstruction(uint32_t instruction,int archSize,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
+	static int   decodeInstructionSwitch(uint32_t instruction,int archSize,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
+	static void  getCRBRFlags(TraceDqr::InstType inst_type,TraceDqr::Reg rs1,TraceDqr::Reg rd,int &crFlag,int &brFlag);
+	static bool  formatInstruction(uint32_t inst,int archSize,TraceDqr::ADDRESS pc,char *dst,int len,TraceDqr::ADDRESS &target);
+	static char *getInstructionText(Section *sp,int index,int archSize,Symtab *symtab);
+	static TraceDqr::DQErr decodeSelfTest(uint32_t numSamples);
 
 	Instruction getInstructionInfo() { return instruction; }
 	Source      getSourceInfo() { return source; }
@@ -862,6 +1542,8 @@ private:
 	int               archSize;
 
 	Section	         *sectionLst;		// owned by elfReader - don't delete
+	SectionIndex     *sectionIndex;		// owned by elfReader - don't delete. May be null
+	int               sectionHint;		// last hit in sectionIndex
 	Symtab           *symtab;			// owned by elfReader - don't delete
 
 	// cached section information
@@ -870,6 +1552,21 @@ private:
 	Section          *cachedSecPtr;
 	int               cachedIndex;
 
+	// recent symbol lookups for each core, most recent first
+
+	enum { symCacheSize = 4 };
+
+	symRange          symCache[DQR_MAXCORES][symCacheSize];
+
+	// results of disassemble(), direct mapped by address. Allocated as one array on the first call, and
+	// entries are overwritten as addresses are disassembled
+
+	enum { instInfoCacheSize = 4096 };
+
+	cachedInstInfo   *instInfoCache;
+
+	void flushInstInfoCache();
+
 	Instruction instruction;
 	Source      source;
 
@@ -880,10 +1577,12 @@ private:
 	TraceDqr::DQErr getDissasembly(TraceDqr::ADDRESS addr,char *&dissText);
 	TraceDqr::DQErr cacheSrcInfo(TraceDqr::ADDRESS addr);
 
+	Section *findSection(TraceDqr::ADDRESS addr);
 	TraceDqr::DQErr lookupInstructionByAddress(TraceDqr::ADDRESS addr,uint32_t &ins,int &insSize);
 	TraceDqr::DQErr findNearestLine(TraceDqr::ADDRESS addr,const char *&file,int &line);
 
-	TraceDqr::DQErr getInstruction(TraceDqr::ADDRESS addr,Instruction &instruction);
+	TraceDqr::DQErr getInstruction(TraceDqr::ADDRESS addr,Instruction &instruction,int core);
+	TraceDqr::DQErr lookupSymbolByAddress(TraceDqr::ADDRESS addr,int core,Sym *&sym);
 
 	// need to make all the decode function static. Might need to move them to public?
 
@@ -896,8 +1595,69 @@ private:
 	static int decodeRV64Q1Instruction(uint32_t instruction,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
 	static int decodeRV64Q2Instruction(uint32_t instruction,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
 	static int decodeRV64Instruction(uint32_t instruction,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
+
+	typedef int (*decodeFunc)(uint32_t instruction,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch);
+
+	enum {
+		decodeTableCSize = 0x10000,	// one entry per 16 bit encoding
+		decodeTable32Size = 0x400,	// one entry per 32 bit opcode/funct3
+	};
+
+	static const decodeTableEntry *rv32DecodeTable;
+	static const decodeTableEntry *rv64DecodeTable;
+
+	static void fillDecodeTableEntry(decodeFunc decoder,uint32_t instruction,decodeTableEntry &entry);
+	static decodeTableEntry *buildDecodeTable(int archSize);
 };
 
+// decodeInstruction() is called for every retired instruction, so it is inline. It does a single
+// table lookup for compressed instructions and most 32 bit instructions, and uses the switch
+// based decoder for the rest (and before the tables have been built)
+
+inline int Disassembler::decodeInstruction(uint32_t instruction,int archSize,int &inst_size,TraceDqr::InstType &inst_type,TraceDqr::Reg &rs1,TraceDqr::Reg &rd,int32_t &immediate,bool &is_branch)
+{
+	const decodeTableEntry *table;
+
+	if (archSize == 64) {
+		table = rv64DecodeTable;
+	}
+	else if (archSize == 32) {
+		table = rv32DecodeTable;
+	}
+	else {
+		table = nullptr;
+	}
+
+	uint32_t index;
+
+	if ((instruction & 0x0003) != 0x0003) {
+		if (instruction < decodeTableCSize) {
+			index = instruction;
+		}
+		else {
+			index = decodeTableCSize + decodeTable32Size;	// garbage in the upper half; use the switch decoder
+		}
+	}
+	else {
+		index = decodeTableCSize + (((instruction & 0x7f) << 3) | ((instruction >> 12) & 0x7));
+	}
+
+	if ((table == nullptr) || (index >= decodeTableCSize + decodeTable32Size) || table[index].useSwitch) {
+		return decodeInstructionSwitch(instruction,archSize,inst_size,inst_type,rs1,rd,immediate,is_branch);
+	}
+
+	const decodeTableEntry *entry = &table[index];
+
+	inst_size = entry->inst_size;
+	inst_type = (TraceDqr::InstType)entry->inst_type;
+	rs1 = (TraceDqr::Reg)entry->rs1;
+	rd = (TraceDqr::Reg)entry->rd;
+	immediate = entry->immediate;
+	is_branch = entry->is_branch != 0;
+
+	return 0;
+}
+
 class AddrStack {
 public:
 	AddrStack(int size = 2048);
@@ -929,6 +1689,9 @@ public:
 	TraceDqr::DQErr setCounts(NexusMessage *nm);
 	int consumeICnt(int core,int numToConsume);
 	int consumeHistory(int core,bool &taken);
+	int getNumNotTaken(int core);
+	int consumeNotTakenRun(int core,int numBranches,TraceDqr::ADDRESS lastBranch);
+	bool consumeRunBranch(int core,TraceDqr::ADDRESS addr);
 	int consumeTakenCount(int core);
 	int consumeNotTakenCount(int core);
 
@@ -937,7 +1700,7 @@ public:
 	int getNumHistoryBits(int core) { return histBit[core]; }
 	uint32_t getTakenCount(int core) { return takenCount[core]; }
 	uint32_t getNotTakenCount(int core) { return notTakenCount[core]; }
-	uint32_t isTaken(int core) { return (history[core] & (1 << histBit[core])) != 0; }
+	uint32_t isTaken(int core) { return (histBit[core] >= 0) && ((history[core] & (((uint64_t)1) << histBit[core])) != 0); }
 
 	int push(int core,TraceDqr::ADDRESS addr) { return stack[core].push(addr); }
 	TraceDqr::ADDRESS pop(int core) { return stack[core].pop(); }
@@ -959,6 +1722,8 @@ private:
     int histBit[DQR_MAXCORES];
     int takenCount[DQR_MAXCORES];
     int notTakenCount[DQR_MAXCORES];
+    int runLeft[DQR_MAXCORES];			// branches of a not-taken run whose history bits were consumed, not yet reached
+    TraceDqr::ADDRESS runEnd[DQR_MAXCORES];	// address of the last branch in the run
     AddrStack stack[DQR_MAXCORES];
 };
 
@@ -6,110 +6,177 @@
 #include <fstream>
 #include <cstring>
 #include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+
+#ifdef WINDOWS
+#include <winsock2.h>
+#else // WINDOWS
+#include <unistd.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif // WINDOWS
 
 #include "dqr.hpp"
 
 using namespace std;
 
-static void usage(char *name)
+static void usage(FILE *out,char *name)
 {
-	printf("Usage: dqr -t tracefile -e elffile [-ca cafile -catype (none | instruction | vector)] [-od objdump] [-btm | -htm | -htmnoopt | event | pathprofiler ] -basename name\n");
-	printf("           [-sf settingsfile] [-srcbits=n] [-src] [-nosrc] [-file] [-nofile] [-func] [-nofunc] [-dasm] [-nodasm]\n");
-	printf("           [-trace] [-notrace] [-pathunix] [-pathwindows] [-pathraw] [--strip=path] [-itcprint | -itcprint=n] [-noitcprint]\n");
-	printf("           [-addrsize=n] [-addrsize=n+] [-32] [-64] [-32+] [-archsize=nn] [-addrsep] [-noaddrsep] [-analytics | -analyitcs=n]\n");
-	printf("           [-noanalytics] [-freq nn] [-tssize=n] [-callreturn] [-nocallreturn] [-branches] [-nobranches] [-msglevel=n]\n");
-	printf("           [-cutpath=<base path>] [-s file] [-r addr] [-debug] [-nodebug] [-allowerrors] [-noallowerrors] [-v] [-h]\n");
-	printf("\n");
-	printf("-t tracefile: Specify the name of the Nexus trace message file. Must contain the file extension (such as .rtd).\n");
-	printf("-e elffile:   Specify the name of the executable elf file. Must contain the file extension (such as .elf).\n");
-	printf("-s simfile:   Specify the name of the simulator output file. When using a simulator output file, cannot use\n");
-	printf("              a tracefile (-t option). Can provide an elf file (-e option), but is not required.\n");
-	printf("-sf propfile: Specify a settings file containing information on trace. Properties may be overridden using command\n");
-	printf("              flags.\n");
-	printf("-p vcdfile:   Specify the name of a PCD file to decode.\n");
-	printf("-ca cafile:   Specify the name of the cycle accurate trace file. Must also specify the -t and -e switches.\n");
-	printf("-catype nn:   Specify the type of the CA trace file. Valid options are none, instruction, and vector\n");
-	printf("-od objdump:  Specify the path and name of the obdjump executable to use. By default uses riscv64-unkonwn-elf-objdump in the\n");
-	printf("              current path unless overridden by the RISCV_PATH environment variable. If not found in either of those, tries the\n");
-	printf("              current working directory.\n");
-	printf("-btm:         Specify the type of the trace file as btm (branch trace messages). On by default.\n");
-	printf("-htm:         Specify the type of the trace file as htm (history trace messages).\n");
-	printf("-htmnoopt:    Specify the type of the trace file as htm without HTM optimizations (history trace messages, no REturn-Address Stack Optimizations).\n");
-	printf("-pathprofiler: Secify the type of the trace file as a path-profiler trace\n");
-	printf("-pcd:         Process the trace as a PCD trace. Can be used to disambiguate between htm, btm instruction, event, and vcd traces when\n");
-	printf("              using a properties files, or htm and btm traces\n");
-	printf("-n basename:  Specify the base name of the Nexus trace message file and the executable elf file. No extension\n");
-	printf("              should be given. The extensions .rtd and .elf will be added to basename.\n");
-	printf("-cutpath=<cutPath>[,<newRoot>]: When searching for source files, <cutPath> is removed from the beginning of thepath name\n");
-	printf("              found in the elf file for the source file name. If <newRoot> is given, it is prepended to the begging of the\n");
-	printf("              after removing <cutPath>. If <cutPath> is not found, <newRoot> is not prepended. This allows having a local copy\n");
-	printf("              of the source file sub-tree. If <cutPath> is not part of the file location, the original source path is used.\n");
-	printf("-src:         Enable display of source lines in output if available (on by default).\n");
-	printf("-nosrc:       Disable display of source lines in output.\n");
-	printf("-file:        Display source file information in output (on by default).\n");
-	printf("-nofile:      Do not display source file information.\n");
-	printf("-dasm:        Display disassembled code in output (on by default).\n");
-	printf("-nodasm:      Do not display disassembled code in output.\n");
-	printf("-func:        Display function name with source information (off by default).\n");
-	printf("-nofunc:      Do not display function information with source information.\n");
-	printf("-trace:       Display trace information in output (off by default).\n");
-	printf("-notrace:     Do not display trace information in output.\n");
-	printf("--strip=path: Strip of the specified path when displaying source file name/path. Strips off all that matches.\n");
-	printf("              Path may be enclosed in quotes if it contains spaces.\n");
-	printf("-itcprint:    Display ITC 0 data as a null terminated string. Data from consecutive ITC 0's will be concatenated\n");
-	printf("              and displayed as a string until a terminating \\0 is found. Also enables processing and display of\n");
-	printf("              no-load-strings.\n");
-	printf("-itcprint=n:  Display ITC channel n data as a null terminated string. Data for consecutive ITC channel n's will be\n");
-	printf("              concatenated and display as a string until a terminating \\n or \\0 is found. Also enabled processing\n");
-	printf("              and display of no-load-strings\n");
-	printf("-noitcprint:  Display ITC 0 data as a normal ITC message; address, data pair\n");
-	printf("-nls:         Enables processing of no-load-strings\n");
-	printf("-nonls:       Disable processing of no-load-strings.\n");
-	printf("-addrsize=n:  Display address as n bits (32 <= n <= 64). Values larger than n bits will print, but take more space and\n");
-	printf("              cause the address field to be jagged. Overrides value address size read from elf file.\n");
-	printf("-addrsize=n+: Display address as n bits (32 <= n <= 64) unless a larger address size is seen, in which case the address\n");
-	printf("              size is increased to accommodate the larger value. When the address size is increased, it stays increased\n");
-	printf("              (sticky) and will be again increased if a new larger value is encountered. Overrides the address size\n");
-	printf("              read from the elf file.\n");
-	printf("-32:          Display addresses as 32 bits. Values lager than 32 bits will print, but take more space and cause\n");
-	printf("              the address field to be jagged. Selected by default if elf file indicates 32 bit address size.\n");
-	printf("              Specifying -32 overrides address size read from elf file\n");
-	printf("-32+          Display addresses as 32 bits until larger addresses are displayed and then adjust up to a larger\n");
-	printf("              enough size to display the entire address. When addresses are adjusted up, they do not later adjust\n");
-	printf("              back down, but stay at the new size unless they need to adjust up again. This is the default setting\n");
-	printf("              if the elf file specifies > 32 bit address size (such as 64). Specifying -32+ overrides the value\n");
-	printf("              read from the elf file\n");
-	printf("-64:          Display addresses as 64 bits. Overrides value read from elf file\n");
-	printf("-archsize=nn: Set the architecture size to 32 or 64 bits instead of getting it from the elf file\n");
-	printf("-addrsep:     For addresses greater than 32 bits, display the upper bits separated from the lower 32 bits by a '-'\n");
-	printf("-noaddrsep:   Do not add a separator for addresses greater than 32 bit between the upper bits and the lower 32 bits\n");
-	printf("              (default).\n");
-	printf("-srcbits=n:   The size in bits of the src field in the trace messages. n must 0 to 16. Setting srcbits to 0 disables\n");
-	printf("              multi-core. n > 0 enables multi-core. If the -srcbits=n switch is not used, srcbits is 0 by default.\n");
-	printf("-analytics:   Compute and display detail level 1 trace analytics.\n");
-	printf("-analytics=n: Specify the detail level for trace analytics display. N sets the level to either 0 (no analytics display)\n");
-	printf("              1 (sort system totals), or 2 (display analytics by core).\n");
-	printf("-noanaylitics: Do not compute and display trace analytics (default). Same as -analytics=0.\n");
-	printf("-freq nn:     Specify the frequency in Hz for the timestamp tics clock. If specified, time instead\n");
-	printf("              of tics will be displayed.\n");
-	printf("-tssize=n:    Specify size in bits of timestamp counter; used for timestamp wrap\n");
-	printf("-callreturn:  Annotate calls, returns, and exceptions\n");
-	printf("-nocallreturn Do not annotate calls, returns, exceptions (default)\n");
-	printf("-branches:    Annotate conditional branches with taken or not taken information\n");
-	printf("-nobrnaches:  Do not annotate conditional branches with taken or not taken information (default)\n");
-	printf("-pathunix:    Show all file paths using unix-type '/' path separators (default)\n");
-	printf("              Also cleans up path, removing // -> /, /./ -> /, and uplevels for each /../\n");
-	printf("-pathwindows: Show all file paths using windows-type '\\' path separators\n");
-	printf("              Also cleans up path, removing // -> /, /./ -> /, and uplevels for each /../\n");
-	printf("-pathraw:     Show all file path in the format stored in the elf file\n");
-	printf("-msglevel=n:  Set the Nexus trace message detail level. n must be >= 0, <= 3\n");
-	printf("-r addr:      Display the label information for the address specified for the elf file specified\n");
-	printf("-debug:       Display some debug information for the trace to aid in debugging the trace decoder\n");
-	printf("-nodebug:     Do not display any debug information for the trace decoder\n");
-	printf("-allowerrors: Keep decoding if errors are found in the trace file (default)\n");
-	printf("-noallowerrors: Stop decoding if errors are found in the trace file\n");
-	printf("-v:           Display the version number of the DQer and exit.\n");
-	printf("-h:           Display this usage information.\n");
+	fprintf(out,"Usage: dqr -t tracefile -e elffile [-ca cafile -catype (none | instruction | vector)] [-od objdump] [-btm | -htm | -htmnoopt | event | pathprofiler ] -basename name\n");
+	fprintf(out,"           [-sf settingsfile] [-srcbits=n] [-src] [-nosrc] [-file] [-nofile] [-func] [-nofunc] [-dasm] [-nodasm]\n");
+	fprintf(out,"           [-trace] [-notrace] [-pathunix] [-pathwindows] [-pathraw] [--strip=path] [-itcprint | -itcprint=n] [-noitcprint]\n");
+	fprintf(out,"           [-addrsize=n] [-addrsize=n+] [-32] [-64] [-32+] [-archsize=nn] [-addrsep] [-noaddrsep] [-analytics | -analyitcs=n]\n");
+	fprintf(out,"           [-noanalytics] [-freq nn] [-tssize=n] [-callreturn] [-nocallreturn] [-branches] [-nobranches] [-msglevel=n]\n");
+	fprintf(out,"           [-cutpath=<base path>] [-s file] [-r addr] [-debug] [-nodebug] [-allowerrors] [-noallowerrors] [-o file]\n");
+	fprintf(out,"           [-nativeelf] [-nonativeelf] [-elfcachedir dir] [-elftimes] [-kmemprewarm] [-odbench file]\n");
+	fprintf(out,"           [-predecodelimit=n] [-decodetest] [-libcache] [-nolibcache] [-srcindex[=file]] [-startuptimes]\n");
+	fprintf(out,"           [-bin file] [-col file] [-v] [-h]\n");
+	fprintf(out,"       dqr -bintotext file [-src] [-file] [-func] [-dasm] [-callreturn] [-branches] [--strip=path]\n");
+	fprintf(out,"       dqr -coltotext file\n");
+	fprintf(out,"       dqr -batch batchfile [-threads=n] [options]\n");
+	fprintf(out,"       dqr -server port [-threads=n] [options]\n");
+	fprintf(out,"\n");
+	fprintf(out,"-t tracefile: Specify the name of the Nexus trace message file. Must contain the file extension (such as .rtd).\n");
+	fprintf(out,"-e elffile:   Specify the name of the executable elf file. Must contain the file extension (such as .elf).\n");
+	fprintf(out,"-s simfile:   Specify the name of the simulator output file. When using a simulator output file, cannot use\n");
+	fprintf(out,"              a tracefile (-t option). Can provide an elf file (-e option), but is not required.\n");
+	fprintf(out,"-sf propfile: Specify a settings file containing information on trace. Properties may be overridden using command\n");
+	fprintf(out,"              flags.\n");
+	fprintf(out,"-p vcdfile:   Specify the name of a PCD file to decode.\n");
+	fprintf(out,"-ca cafile:   Specify the name of the cycle accurate trace file. Must also specify the -t and -e switches.\n");
+	fprintf(out,"-catype nn:   Specify the type of the CA trace file. Valid options are none, instruction, and vector\n");
+	fprintf(out,"-od objdump:  Specify the path and name of the obdjump executable to use. By default uses riscv64-unkonwn-elf-objdump in the\n");
+	fprintf(out,"              current path unless overridden by the RISCV_PATH environment variable. If not found in either of those, tries the\n");
+	fprintf(out,"              current working directory.\n");
+	fprintf(out,"-btm:         Specify the type of the trace file as btm (branch trace messages). On by default.\n");
+	fprintf(out,"-htm:         Specify the type of the trace file as htm (history trace messages).\n");
+	fprintf(out,"-htmnoopt:    Specify the type of the trace file as htm without HTM optimizations (history trace messages, no REturn-Address Stack Optimizations).\n");
+	fprintf(out,"-pathprofiler: Secify the type of the trace file as a path-profiler trace\n");
+	fprintf(out,"-pcd:         Process the trace as a PCD trace. Can be used to disambiguate between htm, btm instruction, event, and vcd traces when\n");
+	fprintf(out,"              using a properties files, or htm and btm traces\n");
+	fprintf(out,"-n basename:  Specify the base name of the Nexus trace message file and the executable elf file. No extension\n");
+	fprintf(out,"              should be given. The extensions .rtd and .elf will be added to basename.\n");
+	fprintf(out,"-cutpath=<cutPath>[,<newRoot>]: When searching for source files, <cutPath> is removed from the beginning of thepath name\n");
+	fprintf(out,"              found in the elf file for the source file name. If <newRoot> is given, it is prepended to the begging of the\n");
+	fprintf(out,"              after removing <cutPath>. If <cutPath> is not found, <newRoot> is not prepended. This allows having a local copy\n");
+	fprintf(out,"              of the source file sub-tree. If <cutPath> is not part of the file location, the original source path is used.\n");
+	fprintf(out,"              With -srcindex, a file that is deeper under <newRoot> is found too.\n");
+	fprintf(out,"-src:         Enable display of source lines in output if available (on by default).\n");
+	fprintf(out,"-nosrc:       Disable display of source lines in output.\n");
+	fprintf(out,"-file:        Display source file information in output (on by default).\n");
+	fprintf(out,"-nofile:      Do not display source file information.\n");
+	fprintf(out,"-dasm:        Display disassembled code in output (on by default).\n");
+	fprintf(out,"-nodasm:      Do not display disassembled code in output.\n");
+	fprintf(out,"-func:        Display function name with source information (off by default).\n");
+	fprintf(out,"-nofunc:      Do not display function information with source information.\n");
+	fprintf(out,"-trace:       Display trace information in output (off by default).\n");
+	fprintf(out,"-notrace:     Do not display trace information in output.\n");
+	fprintf(out,"--strip=path: Strip of the specified path when displaying source file name/path. Strips off all that matches.\n");
+	fprintf(out,"              Path may be enclosed in quotes if it contains spaces.\n");
+	fprintf(out,"-itcprint:    Display ITC 0 data as a null terminated string. Data from consecutive ITC 0's will be concatenated\n");
+	fprintf(out,"              and displayed as a string until a terminating \\0 is found. Also enables processing and display of\n");
+	fprintf(out,"              no-load-strings.\n");
+	fprintf(out,"-itcprint=n:  Display ITC channel n data as a null terminated string. Data for consecutive ITC channel n's will be\n");
+	fprintf(out,"              concatenated and display as a string until a terminating \\n or \\0 is found. Also enabled processing\n");
+	fprintf(out,"              and display of no-load-strings\n");
+	fprintf(out,"-noitcprint:  Display ITC 0 data as a normal ITC message; address, data pair\n");
+	fprintf(out,"-nls:         Enables processing of no-load-strings\n");
+	fprintf(out,"-nonls:       Disable processing of no-load-strings.\n");
+	fprintf(out,"-addrsize=n:  Display address as n bits (32 <= n <= 64). Values larger than n bits will print, but take more space and\n");
+	fprintf(out,"              cause the address field to be jagged. Overrides value address size read from elf file.\n");
+	fprintf(out,"-addrsize=n+: Display address as n bits (32 <= n <= 64) unless a larger address size is seen, in which case the address\n");
+	fprintf(out,"              size is increased to accommodate the larger value. When the address size is increased, it stays increased\n");
+	fprintf(out,"              (sticky) and will be again increased if a new larger value is encountered. Overrides the address size\n");
+	fprintf(out,"              read from the elf file.\n");
+	fprintf(out,"-32:          Display addresses as 32 bits. Values lager than 32 bits will print, but take more space and cause\n");
+	fprintf(out,"              the address field to be jagged. Selected by default if elf file indicates 32 bit address size.\n");
+	fprintf(out,"              Specifying -32 overrides address size read from elf file\n");
+	fprintf(out,"-32+          Display addresses as 32 bits until larger addresses are displayed and then adjust up to a larger\n");
+	fprintf(out,"              enough size to display the entire address. When addresses are adjusted up, they do not later adjust\n");
+	fprintf(out,"              back down, but stay at the new size unless they need to adjust up again. This is the default setting\n");
+	fprintf(out,"              if the elf file specifies > 32 bit address size (such as 64). Specifying -32+ overrides the value\n");
+	fprintf(out,"              read from the elf file\n");
+	fprintf(out,"-64:          Display addresses as 64 bits. Overrides value read from elf file\n");
+	fprintf(out,"-archsize=nn: Set the architecture size to 32 or 64 bits instead of getting it from the elf file\n");
+	fprintf(out,"-addrsep:     For addresses greater than 32 bits, display the upper bits separated from the lower 32 bits by a '-'\n");
+	fprintf(out,"-noaddrsep:   Do not add a separator for addresses greater than 32 bit between the upper bits and the lower 32 bits\n");
+	fprintf(out,"              (default).\n");
+	fprintf(out,"-srcbits=n:   The size in bits of the src field in the trace messages. n must 0 to 16. Setting srcbits to 0 disables\n");
+	fprintf(out,"              multi-core. n > 0 enables multi-core. If the -srcbits=n switch is not used, srcbits is 0 by default.\n");
+	fprintf(out,"-analytics:   Compute and display detail level 1 trace analytics.\n");
+	fprintf(out,"-analytics=n: Specify the detail level for trace analytics display. N sets the level to either 0 (no analytics display)\n");
+	fprintf(out,"              1 (sort system totals), or 2 (display analytics by core).\n");
+	fprintf(out,"-noanaylitics: Do not compute and display trace analytics (default). Same as -analytics=0.\n");
+	fprintf(out,"-freq nn:     Specify the frequency in Hz for the timestamp tics clock. If specified, time instead\n");
+	fprintf(out,"              of tics will be displayed.\n");
+	fprintf(out,"-tssize=n:    Specify size in bits of timestamp counter; used for timestamp wrap\n");
+	fprintf(out,"-callreturn:  Annotate calls, returns, and exceptions\n");
+	fprintf(out,"-nocallreturn Do not annotate calls, returns, exceptions (default)\n");
+	fprintf(out,"-branches:    Annotate conditional branches with taken or not taken information\n");
+	fprintf(out,"-nobrnaches:  Do not annotate conditional branches with taken or not taken information (default)\n");
+	fprintf(out,"-pathunix:    Show all file paths using unix-type '/' path separators (default)\n");
+	fprintf(out,"              Also cleans up path, removing // -> /, /./ -> /, and uplevels for each /../\n");
+	fprintf(out,"-pathwindows: Show all file paths using windows-type '\\' path separators\n");
+	fprintf(out,"              Also cleans up path, removing // -> /, /./ -> /, and uplevels for each /../\n");
+	fprintf(out,"-pathraw:     Show all file path in the format stored in the elf file\n");
+	fprintf(out,"-msglevel=n:  Set the Nexus trace message detail level. n must be >= 0, <= 3\n");
+	fprintf(out,"-r addr:      Display the label information for the address specified for the elf file specified\n");
+	fprintf(out,"-debug:       Display some debug information for the trace to aid in debugging the trace decoder\n");
+	fprintf(out,"-nodebug:     Do not display any debug information for the trace decoder\n");
+	fprintf(out,"-allowerrors: Keep decoding if errors are found in the trace file (default)\n");
+	fprintf(out,"-noallowerrors: Stop decoding if errors are found in the trace file\n");
+	fprintf(out,"-o file:      Write the output to file instead of stdout.\n");
+	fprintf(out,"-batch file:  Run a decode for each line of file. Each line holds the options for one decode, and must include\n");
+	fprintf(out,"              -o to name its output file. Options given on the command line apply to all decodes. Decodes run in\n");
+	fprintf(out,"              parallel, and decodes of the same elf file share the objdump results. Lines starting with # are ignored.\n");
+	fprintf(out,"-threads=n:   Number of decodes to run at the same time with -batch or -server. Defaults to the number of hardware\n");
+	fprintf(out,"              threads.\n");
+	fprintf(out,"-server port: Run as a server listening on localhost port. Each connection sends one line with the options for\n");
+	fprintf(out,"              a decode (or -r lookup), and the output is sent back on the connection. Elf files are kept loaded\n");
+	fprintf(out,"              between requests. Options given on the command line apply to all requests. A request may only use\n");
+	fprintf(out,"              the options that name the files to decode (-t, -e, -n, -s, -ca, -p, -r) and the ones that choose\n");
+	fprintf(out,"              what is displayed; options that write files or run programs, -sf, -o, -debug, and -nodebug are\n");
+	fprintf(out,"              refused. Any local process can connect to the port.\n");
+	fprintf(out,"-nativeelf:   Read elf files and binary blobs directly, and generate the disassembly text in the decoder\n");
+	fprintf(out,"              (default). objdump is still used for files that can't be read directly.\n");
+	fprintf(out,"-nonativeelf: Read elf files and binary blobs with objdump, and use the objdump disassembly text.\n");
+	fprintf(out,"-elfcachedir dir: Save the symbols, code, and line information read from each elf file in dir, and use them\n");
+	fprintf(out,"              instead of reading the elf file or running objdump when the same elf file is used again.\n");
+	fprintf(out,"-elftimes:    Display how long each elf file, shared library, and binary blob took to load. The shared libraries\n");
+	fprintf(out,"              and blobs for a process are loaded in parallel.\n");
+	fprintf(out,"-predecodelimit=n: Build the per-instruction predecode tables for an elf file only if they fit in n megabytes\n");
+	fprintf(out,"              (default 256). 0 disables them. The predecodeLimit property in a settings file overrides this.\n");
+	fprintf(out,"-kmemprewarm: For linux traces, read all the kernel memory files in the kmem directory in parallel before\n");
+	fprintf(out,"              decoding, instead of reading them as the trace reaches them.\n");
+	fprintf(out,"-libcache:    For linux traces, read each shared library once and share it between all the processes that\n");
+	fprintf(out,"              map it (default).\n");
+	fprintf(out,"-nolibcache:  For linux traces, read the shared libraries again for each process.\n");
+	fprintf(out,"-srcindex:    List the files under the <newRoot> of -cutpath once, and find a source file whose path after\n");
+	fprintf(out,"              <cutPath> is not directly under <newRoot> by the file under <newRoot> whose path ends with it.\n");
+	fprintf(out,"-srcindex=file: Same as -srcindex, and save the list in file and read it from file instead of searching\n");
+	fprintf(out,"              <newRoot> again in later runs. Remove file when files are added to or moved in <newRoot>.\n");
+	fprintf(out,"-startuptimes: Display how long each phase of setting up a trace took. Phases that don't depend on each other\n");
+	fprintf(out,"              run at the same time.\n");
+	fprintf(out,"-bin file:    Write the decoded instructions with their source and function information to file in the\n");
+	fprintf(out,"              binary trace format (see BinTrace in dqr.hpp) instead of listing them. Trace messages and\n");
+	fprintf(out,"              analytics are still listed.\n");
+	fprintf(out,"-bintotext file: List the instructions in a binary trace file written with -bin.\n");
+	fprintf(out,"-col file:    Write the decoded instructions to file as columns (pc, core, timestamp, function, file, line,\n");
+	fprintf(out,"              call/return and branch flags) in row groups, with function and file names in dictionaries\n");
+	fprintf(out,"              (see ColTrace in dqr.hpp), instead of listing them. Can be used with -bin.\n");
+	fprintf(out,"-coltotext file: List the rows of a columnar trace file written with -col, one line per instruction with\n");
+	fprintf(out,"              a tab between columns. The first line has the column names.\n");
+	fprintf(out,"-odbench file: Time the objdump output parser on file, which holds the output of objdump -t -d -h -l elffile,\n");
+	fprintf(out,"              and exit.\n");
+	fprintf(out,"-decodetest:  Check that the instruction decode tables give the same results as the switch based decoder\n");
+	fprintf(out,"              for every 16 bit encoding and 16M sampled 32 bit encodings, time both decoders, and exit.\n");
+	fprintf(out,"-v:           Display the version number of the DQer and exit.\n");
+	fprintf(out,"-h:           Display this usage information.\n");
 }
 
 static const char *stripPath(const char *prefix,const char *srcpath)
@@ -173,16 +240,16 @@ const char *prvToTxt(uint8_t prv)
   return "?";
 }
 
-void dumpPidMap(int numPids,pidMap *pidMap)
+void dumpPidMap(FILE *out,int numPids,pidMap *pidMap)
 {
   if (numPids > 0) {
-    printf(" Pid    Name\n");
+    fprintf(out," Pid    Name\n");
 
     for (int i = 0; i < numPids; i++) {
-      printf("%6u  %s\n",pidMap[i].pid,pidMap[i].name);
+      fprintf(out,"%6u  %s\n",pidMap[i].pid,pidMap[i].name);
     }
 
-    printf("\n");
+    fprintf(out,"\n");
   }
 }
 
@@ -192,1229 +259,2745 @@ void fixPidNames(int numPids,pidMap *pidMap)
   }
 }
 
-int main(int argc, char *argv[])
+// OutWriter: collects decode output in one large buffer and hands it to the stream in big
+// writes. Numbers are formatted by hand; the per-instruction fprintf() calls were most of
+// the time spent producing a listing
+
+class OutWriter {
+public:
+	OutWriter(FILE *out);
+	~OutWriter();
+
+	void flush();
+
+	void put(char c) { if (bufLen >= bufSize) { flush(); } buf[bufLen++] = c; }
+	void put(const char *s) { put(s,strlen(s)); }
+	void put(const char *s,size_t len);
+	void putDec(int v);
+	void putUDec(uint64_t v);
+	void putHex(uint32_t v,int minWidth);
+	void pad(uint64_t start,int width);
+
+	uint64_t getCount() { return flushed + bufLen; }
+
+private:
+	enum { outBufSize = 256*1024 };
+
+	FILE    *out;
+	char    *buf;
+	size_t   bufSize;
+	size_t   bufLen;
+	uint64_t flushed;
+	char     smallBuf[256];
+};
+
+OutWriter::OutWriter(FILE *out)
 {
-	char *tf_name = nullptr;
-	char *base_name = nullptr;
-	char *ef_name = nullptr;
-	char *sf_name = nullptr;
-	char *ca_name = nullptr;
-	char *pf_name = nullptr;
-	char *vf_name = nullptr;
-	const char *od_name = DEFAULTOBJDUMPNAME;
-	char buff[128];
-	int buff_index = 0;
-	bool usage_flag = false;
-	bool version_flag = false;
-	bool src_flag = true;
-	bool file_flag = true;
-	bool dasm_flag = true;
-	bool trace_flag = false;
-	bool func_flag = false;
-	int tssize = 40;
-	uint32_t freq = 0;
-	char *strip_flag = nullptr;
-	int  numAddrBits = 0;
-	uint32_t addrDispFlags = 0;
-	int srcbits = 0;
-	int analytics_detail = 0;
-	int itcPrintOpts = TraceDqr::ITC_OPT_NLS;
-	int itcPrintChannel = 0;
-	bool showCallsReturns = false;
-	bool showBranches = false;
-	TraceDqr::pathType pt = TraceDqr::PATH_TO_UNIX;
-	int archSize = 32;
-	int msgLevel = 2;
-	TraceDqr::CATraceType caType = TraceDqr::CATRACE_NONE;
-	TraceDqr::TraceType traceType = TraceDqr::TRACETYPE_BTM;
-	char *cutPath = nullptr;
-	char *newRoot = nullptr;
-	bool ctf_flag = false;
-	bool linuxTrace = false;
-	bool allowErrors = true;
+	this->out = out;
+
+	buf = new (std::nothrow) char[outBufSize];
+	if (buf != nullptr) {
+		bufSize = outBufSize;
+	}
+	else {
+		buf = smallBuf;
+		bufSize = sizeof smallBuf;
+	}
+
+	bufLen = 0;
+	flushed = 0;
+}
+
+OutWriter::~OutWriter()
+{
+	flush();
+
+	if (buf != smallBuf) {
+		delete [] buf;
+	}
+
+	buf = nullptr;
+}
+
+void OutWriter::flush()
+{
+	if (bufLen > 0) {
+		fwrite(buf,1,bufLen,out);
+		flushed += bufLen;
+		bufLen = 0;
+	}
+}
+
+void OutWriter::put(const char *s,size_t len)
+{
+	if (bufLen + len > bufSize) {
+		flush();
+
+		if (len >= bufSize) {
+			fwrite(s,1,len,out);
+			flushed += len;
+			return;
+		}
+	}
+
+	memcpy(&buf[bufLen],s,len);
+	bufLen += len;
+}
+
+void OutWriter::putDec(int v)
+{
+	if (v < 0) {
+		put('-');
+		putUDec((uint64_t)0 - (uint64_t)(int64_t)v);
+	}
+	else {
+		putUDec((uint64_t)v);
+	}
+}
+
+void OutWriter::putUDec(uint64_t v)
+{
+	char digits[20];
+	int n = sizeof digits;
+
+	do {
+		digits[--n] = '0' + (v % 10);
+		v /= 10;
+	} while (v != 0);
+
+	put(&digits[n],sizeof digits - n);
+}
+
+void OutWriter::putHex(uint32_t v,int minWidth)
+{
+	char digits[8];
+	int n = sizeof digits;
+
+	do {
+		digits[--n] = "0123456789abcdef"[v & 0xf];
+		v >>= 4;
+	} while (v != 0);
+
+	for (int i = sizeof digits - n; i < minWidth; i++) {
+		put('0');
+	}
+
+	put(&digits[n],sizeof digits - n);
+}
+
+// pad(): add spaces until width characters have been written since start
+
+void OutWriter::pad(uint64_t start,int width)
+{
+	while (getCount() < start + width) {
+		put(' ');
+	}
+}
+
+// InstLineCache: keeps the rendered "    address:   opcode  disassembly" part of an
+// instruction line for recently seen addresses so loops do not re-render the same text.
+// Entries are keyed by everything that goes into the text, including the address print
+// width, which can grow while decoding when auto width is on
+
+class InstLineCache {
+public:
+	InstLineCache();
+	~InstLineCache();
+
+	void put(OutWriter &w,Instruction *instInfo,int instlevel);
+
+private:
+	enum { cacheSize = 2048, lineMax = 112 };
+
+	struct lineEntry {
+		TraceDqr::ADDRESS address;
+		TraceDqr::RV_INST instruction;
+		const char       *instructionText;
+		int               instSize;
+		int               addrWidth;
+		int               len;
+		char              line[lineMax];
+	};
+
+	lineEntry *cache;
+};
+
+InstLineCache::InstLineCache()
+{
+	cache = new (std::nothrow) lineEntry[cacheSize];
+
+	if (cache != nullptr) {
+		for (int i = 0; i < cacheSize; i++) {
+			cache[i].len = -1;
+		}
+	}
+}
+
+InstLineCache::~InstLineCache()
+{
+	if (cache != nullptr) {
+		delete [] cache;
+		cache = nullptr;
+	}
+}
+
+void InstLineCache::put(OutWriter &w,Instruction *instInfo,int instlevel)
+{
+	lineEntry *ep = nullptr;
+
+	if (cache != nullptr) {
+		ep = &cache[(instInfo->address >> 1) & (cacheSize-1)];
+
+		if ((ep->len >= 0) &&
+		    (ep->address == instInfo->address) &&
+		    (ep->instruction == instInfo->instruction) &&
+		    (ep->instructionText == instInfo->instructionText) &&
+		    (ep->instSize == instInfo->instSize) &&
+		    (ep->addrWidth == Instruction::getAddrPrintWidth())) {
+			w.put(ep->line,ep->len);
+			return;
+		}
+	}
+
+	char dst[512];
+	char line[sizeof dst * 2 + 32];
+	int n;
+
+	instInfo->addressToText(dst,sizeof dst,0);
+	n = snprintf(line,sizeof line,"    %s:",dst);
+
+	while (n < 20) {
+		line[n++] = ' ';
+	}
+
+	instInfo->instructionToText(dst,sizeof dst,instlevel);
+	n += snprintf(&line[n],sizeof line - n,"  %s",dst);
+
+	w.put(line,n);
+
+	if ((ep != nullptr) && (n <= lineMax)) {
+		ep->address = instInfo->address;
+		ep->instruction = instInfo->instruction;
+		ep->instructionText = instInfo->instructionText;
+		ep->instSize = instInfo->instSize;
+		ep->addrWidth = Instruction::getAddrPrintWidth();
+		ep->len = n;
+		memcpy(ep->line,line,n);
+	}
+}
+
+// putContext(): the [core.pid.mode:name] or [core] prefix on each output line
+
+static void putContext(OutWriter &w,bool linuxTrace,int srcbits,int coreId,uint32_t pid,uint8_t prv,const char *pidName)
+{
+	if (linuxTrace) {
+		w.put('[');
+		w.putDec(coreId);
+		w.put('.');
+
+		if ((pidName == nullptr) && (pid == 0xffffffff)) {
+			w.put('?');
+		}
+		else {
+			w.putDec((int)pid);
+		}
+
+		w.put('.');
+		w.put(prvToTxt(prv));
+
+		if (pidName != nullptr) {
+			w.put(':');
+			w.put(pidName);
+		}
+
+		w.put("] ");
+	}
+	else if (srcbits > 0) {
+		w.put('[');
+		w.putDec(coreId);
+		w.put("] ");
+	}
+}
+
+// putFileLine(): the File: line for a source file and line number. The part of the path -cutpath replaced
+// is shown in []
+
+static void putFileLine(OutWriter &w,Source *srcInfo,const char *strip_flag)
+{
+	const char *sfp;
+
+	sfp = stripPath(strip_flag,srcInfo->sourceFile);
+
+	int sfpl = 0;
+	int sfl = 0;
+	int stripped = 0;
+
+	if (sfp != srcInfo->sourceFile) {
+		sfpl = strlen(sfp);
+		sfl = strlen(srcInfo->sourceFile);
+		stripped = sfl - sfpl;
+	}
+
+	if (stripped < srcInfo->cutPathIndex) {
+		w.put("File: [");
+
+		if (sfp != srcInfo->sourceFile) {
+			w.put("..");
+		}
+
+		w.put(&srcInfo->sourceFile[stripped],srcInfo->cutPathIndex - stripped);
+
+		w.put(']');
+		w.put(&srcInfo->sourceFile[srcInfo->cutPathIndex]);
+	}
+	else {
+		if (sfp != srcInfo->sourceFile) {
+			w.put("File: ..");
+		}
+		else {
+			w.put("File: ");
+		}
+
+		w.put(sfp);
+	}
+
+	w.put(':');
+	w.putDec((int)srcInfo->sourceLineNum);
+	w.put('\n');
+}
+
+// putInstFlags(): the [t]/[nt] and [Call,Return,...] annotations at the end of an instruction line
+
+static void putInstFlags(OutWriter &w,Instruction *instInfo,bool showBranches,bool showCallsReturns)
+{
+	if (showBranches == true) {
+		switch (instInfo->brFlags) {
+		case TraceDqr::BRFLAG_none:
+			break;
+		case TraceDqr::BRFLAG_unknown:
+			w.put(" [u]");
+			break;
+		case TraceDqr::BRFLAG_taken:
+			w.put(" [t]");
+			break;
+		case TraceDqr::BRFLAG_notTaken:
+			w.put(" [nt]");
+			break;
+		}
+	}
+
+	if (showCallsReturns == true) {
+		if (instInfo->CRFlag != TraceDqr::isNone) {
+			char sep = '[';
+
+			w.put(' ');
+
+			if (instInfo->CRFlag & TraceDqr::isCall) {
+				w.put(sep);
+				w.put("Call");
+				sep = ',';
+			}
+
+			if (instInfo->CRFlag & TraceDqr::isReturn) {
+				w.put(sep);
+				w.put("Return");
+				sep = ',';
+			}
+
+			if (instInfo->CRFlag & TraceDqr::isSwap) {
+				w.put(sep);
+				w.put("Swap");
+				sep = ',';
+			}
+
+			if (instInfo->CRFlag & TraceDqr::isInterrupt) {
+				w.put(sep);
+				w.put("Interrupt");
+				sep = ',';
+			}
+
+			if (instInfo->CRFlag & TraceDqr::isException) {
+				w.put(sep);
+				w.put("Exception");
+				sep = ',';
+			}
+
+			if (instInfo->CRFlag & TraceDqr::isExceptionReturn) {
+				w.put(sep);
+				w.put("Exception Return");
+				sep = ',';
+			}
+
+			if (sep == '[') {
+				w.put('[');
+			}
+
+			w.put(']');
+		}
+	}
+}
+
+// binToText(): list a binary trace file written with -bin the way decode() lists a trace. Pid names and
+// cycle accurate pipe information are not kept in the binary file, so they are not shown
+
+static int binToText(const char *bin_name,FILE *out,bool src_flag,bool file_flag,bool dasm_flag,bool func_flag,bool showBranches,bool showCallsReturns,const char *strip_flag)
+{
+	BinTraceReader reader;
+
+	if (reader.open(bin_name) != TraceDqr::DQERR_OK) {
+		fprintf(out,"Error: cannot read binary trace file %s\n",bin_name);
+		return 1;
+	}
+
+	const BinTrace::header *hdr = reader.getHeader();
+
+	reader.applyDisplaySettings();
+
+	bool linuxTrace = (hdr->flags & BinTrace::flagLinuxTrace) != 0;
+	bool timestamps = (hdr->flags & BinTrace::flagTimestamps) != 0;
+	int srcbits = hdr->srcBits;
+
+	OutWriter w(out);
+	InstLineCache lineCache;
+	BinTrace::instInfo binInst;
+	Instruction instInfo;
+	Source srcInfo;
+	uint32_t lastLine = BinTrace::noIndex;
+	TraceDqr::ADDRESS lastAddress = 0;
+	int lastInstSize = 0;
+	bool firstPrint = true;
+	TraceDqr::DQErr ec;
+
+	memset(&instInfo,0,sizeof instInfo);
+	memset(&srcInfo,0,sizeof srcInfo);
+
+	while ((ec = reader.nextInstruction(binInst)) == TraceDqr::DQERR_OK) {
+		const BinTrace::addrEntry *ap = binInst.addr;
+
+		instInfo.coreId = binInst.core;
+		instInfo.prv = binInst.prv;
+		instInfo.pid = binInst.pid;
+		instInfo.CRFlag = binInst.crFlags;
+		instInfo.brFlags = binInst.brFlags;
+		instInfo.address = binInst.address;
+		instInfo.instSize = ap->instSize;
+		instInfo.instruction = ap->instruction;
+		instInfo.instructionText = (char *)reader.getString(ap->text);
+		instInfo.addressLabel = reader.getSymName(ap->sym);
+		instInfo.addressLabelOffset = (instInfo.addressLabel != nullptr) ? ap->symOffset : 0;
+		instInfo.timestamp = binInst.timestamp;
+
+		if (ap->line != lastLine) {
+			const BinTrace::lineEntry *lp = reader.getLine(ap->line);
+
+			lastLine = ap->line;
+
+			if (lp != nullptr) {
+				srcInfo.coreId = binInst.core;
+				srcInfo.prv = binInst.prv;
+				srcInfo.pid = binInst.pid;
+				srcInfo.sourceFile = reader.getFileName(lp->file);
+				srcInfo.sourceLine = reader.getString(lp->text);
+				srcInfo.sourceLineNum = lp->lineNum;
+
+				if (file_flag && (srcInfo.sourceFile != nullptr)) {
+					if (firstPrint == false) {
+						w.put('\n');
+					}
+
+					putContext(w,linuxTrace,srcbits,srcInfo.coreId,srcInfo.pid,srcInfo.prv,nullptr);
+					putFileLine(w,&srcInfo,strip_flag);
+
+					firstPrint = false;
+				}
+
+				if (src_flag && (srcInfo.sourceLine != nullptr)) {
+					putContext(w,linuxTrace,srcbits,srcInfo.coreId,srcInfo.pid,srcInfo.prv,nullptr);
+
+					w.put("Source: ");
+					w.put(srcInfo.sourceLine);
+					w.put('\n');
+
+					firstPrint = false;
+				}
+			}
+		}
+
+		if (dasm_flag) {
+			if (func_flag) {
+				if (((instInfo.addressLabel != nullptr) && (instInfo.addressLabelOffset == 0)) || (instInfo.address != (lastAddress + lastInstSize / 8))) {
+					if (instInfo.addressLabel != nullptr) {
+						putContext(w,linuxTrace,srcbits,instInfo.coreId,instInfo.pid,instInfo.prv,nullptr);
+
+						w.put('<');
+						w.put(instInfo.addressLabel);
+						if (instInfo.addressLabelOffset != 0) {
+							w.put('+');
+							w.putHex((uint32_t)instInfo.addressLabelOffset,0);
+						}
+						w.put(">\n");
+					}
+				}
+
+				lastAddress = instInfo.address;
+				lastInstSize = instInfo.instSize;
+			}
+
+			putContext(w,linuxTrace,srcbits,instInfo.coreId,instInfo.pid,instInfo.prv,nullptr);
+
+			if (timestamps && (instInfo.timestamp != 0)) {
+				uint64_t start = w.getCount();
+
+				w.put("t:");
+				w.putDec((int)instInfo.timestamp);
+				w.put(' ');
+				w.pad(start,14);
+			}
+
+			lineCache.put(w,&instInfo,1);
+			putInstFlags(w,&instInfo,showBranches,showCallsReturns);
+
+			w.put('\n');
+
+			firstPrint = false;
+		}
+	}
+
+	w.flush();
+
+	if (ec != TraceDqr::DQERR_EOF) {
+		fprintf(out,"Error (%d) terminated binary trace listing\n",ec);
+		return 1;
+	}
+
+	if (firstPrint == false) {
+		fprintf(out,"\n");
+	}
+
+	fprintf(out,"End of Trace File\n");
+
+	return 0;
+}
+
+// colToText(): list a columnar trace file written with -col. Each row group is read a column at a time, and
+// the rows are written out with a tab between columns. The pc is in hex, and dictionary columns are shown
+// as their strings ("-" for none)
+
+static int colToText(const char *col_name,FILE *out)
+{
+	ColTraceReader reader;
+
+	if (reader.open(col_name) != TraceDqr::DQERR_OK) {
+		fprintf(out,"Error: cannot read columnar trace file %s\n",col_name);
+		return 1;
+	}
+
+	int numColumns = reader.getNumColumns();
+	int pcColumn = reader.findColumn("pc");
+	uint32_t maxRows = 0;
+
+	for (uint32_t rg = 0; rg < reader.getNumRowGroups(); rg++) {
+		if (reader.getRowGroupRows(rg) > maxRows) {
+			maxRows = reader.getRowGroupRows(rg);
+		}
+	}
+
+	uint64_t **values = new uint64_t *[numColumns];
+	bool allocFailed = false;
+
+	for (int col = 0; col < numColumns; col++) {
+		values[col] = new (std::nothrow) uint64_t [maxRows];
+		if (values[col] == nullptr) {
+			allocFailed = true;
+		}
+	}
+
+	if (allocFailed) {
+		fprintf(out,"Error: not enough memory for the %u row row groups of %s\n",maxRows,col_name);
+
+		for (int col = 0; col < numColumns; col++) {
+			delete [] values[col];
+		}
+
+		delete [] values;
+
+		return 1;
+	}
+
+	OutWriter w(out);
+	int rc = 0;
+
+	for (int col = 0; col < numColumns; col++) {
+		if (col > 0) {
+			w.put('\t');
+		}
+
+		w.put(reader.getColumnName(col));
+	}
+
+	w.put('\n');
+
+	for (uint32_t rg = 0; (rc == 0) && (rg < reader.getNumRowGroups()); rg++) {
+		uint32_t numRows = reader.getRowGroupRows(rg);
+
+		for (int col = 0; col < numColumns; col++) {
+			if (reader.readColumn(rg,col,values[col]) != TraceDqr::DQERR_OK) {
+				rc = 1;
+				break;
+			}
+		}
+
+		for (uint32_t row = 0; (rc == 0) && (row < numRows); row++) {
+			for (int col = 0; col < numColumns; col++) {
+				uint64_t v = values[col][row];
+
+				if (col > 0) {
+					w.put('\t');
+				}
+
+				if (reader.isDictColumn(col)) {
+					const char *s = reader.getDictString(col,v);
+
+					w.put((s != nullptr) ? s : "-");
+				}
+				else if (col == pcColumn) {
+					char hex[32];
+
+					snprintf(hex,sizeof hex,"0x%llx",(unsigned long long)v);
+					w.put(hex);
+				}
+				else {
+					w.putUDec(v);
+				}
+			}
+
+			w.put('\n');
+		}
+	}
+
+	w.flush();
+
+	for (int col = 0; col < numColumns; col++) {
+		delete [] values[col];
+	}
+
+	delete [] values;
+
+	if (rc != 0) {
+		fprintf(out,"Error: columnar trace file %s is corrupt\n",col_name);
+	}
+
+	return rc;
+}
+
+// decode(): do what the command line options in argv ask for, writing the results to out
+
+static int decode(int argc,char *argv[],FILE *out)
+{
+	char *tf_name = nullptr;
+	char *base_name = nullptr;
+	char *ef_name = nullptr;
+	char *sf_name = nullptr;
+	char *ca_name = nullptr;
+	char *pf_name = nullptr;
+	char *vf_name = nullptr;
+	char *bin_name = nullptr;
+	char *col_name = nullptr;
+	char *bintotext_name = nullptr;
+	char *coltotext_name = nullptr;
+	const char *od_name = DEFAULTOBJDUMPNAME;
+	char buff[128];
+	int buff_index = 0;
+	bool usage_flag = false;
+	bool version_flag = false;
+	bool src_flag = true;
+	bool file_flag = true;
+	bool dasm_flag = true;
+	bool trace_flag = false;
+	bool func_flag = false;
+	int tssize = 40;
+	uint32_t freq = 0;
+	char *strip_flag = nullptr;
+	int  numAddrBits = 0;
+	uint32_t addrDispFlags = 0;
+	int srcbits = 0;
+	int analytics_detail = 0;
+	int itcPrintOpts = TraceDqr::ITC_OPT_NLS;
+	int itcPrintChannel = 0;
+	bool showCallsReturns = false;
+	bool showBranches = false;
+	TraceDqr::pathType pt = TraceDqr::PATH_TO_UNIX;
+	int archSize = 32;
+	int msgLevel = 2;
+	TraceDqr::CATraceType caType = TraceDqr::CATRACE_NONE;
+	TraceDqr::TraceType traceType = TraceDqr::TRACETYPE_BTM;
+	char *cutPath = nullptr;
+	char *newRoot = nullptr;
+	bool ctf_flag = false;
+	bool linuxTrace = false;
+	bool allowErrors = true;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp("-t",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -t requires a file name\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			base_name = nullptr;
+			sf_name = nullptr;
+
+			tf_name = argv[i];
+		}
+		else if (strcmp("-n",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -n requires a file name\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			ef_name = nullptr;
+			tf_name = nullptr;
+			sf_name = nullptr;
+
+			base_name = argv[i];
+		}
+		else if (strcmp("-e",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -e requires a file name\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			base_name = nullptr;
+
+			ef_name = argv[i];
+		}
+		else if (strcmp("-sf",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -sf requires a file name\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			pf_name = argv[i];
+		}
+		else if (strcmp("-ca",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -ca requires a file name\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			ca_name = argv[i];
+		}
+		else if (strcmp("-od",argv[i]) == 0) {
+			i += 1;
+			if (i > argc) {
+				fprintf(out,"Error: option -od requires a file name/path\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			od_name = argv[i];
+		}
+		else if (strcmp("-ctf",argv[i]) == 0) {
+			ctf_flag = true;
+		}
+		else if (strcmp("-noctf",argv[i]) == 0) {
+			ctf_flag = false;
+		}
+		else if (strcmp("-btm",argv[i]) == 0) {
+			traceType = TraceDqr::TRACETYPE_BTM;
+		}
+		else if (strcmp("-htm",argv[i]) == 0) {
+			traceType = TraceDqr::TRACETYPE_HTM;
+		}
+		else if (strcmp("-htmnoopt",argv[i]) == 0) {
+			traceType = TraceDqr::TRACETYPE_HTMNOOPT;
+		}
+		else if (strcmp("-event",argv[i]) == 0) {
+			traceType = TraceDqr::TRACETYPE_EVENT;
+		}
+		else if (strcmp("-pathprofiler",argv[i]) == 0) {
+			traceType = TraceDqr::TRACETYPE_PATH;
+		}
+		else if (strcmp("-pcd",argv[i]) == 0) {
+			traceType = TraceDqr::TRACETYPE_VCD;
+		}
+		else if (strcmp("-src",argv[i]) == 0) {
+			src_flag = true;
+		}
+		else if (strcmp("-nosrc",argv[i]) == 0) {
+			src_flag = false;
+		}
+		else if (strcmp("-file",argv[i]) == 0) {
+			file_flag = true;
+		}
+		else if (strcmp("-nofile",argv[i]) == 0) {
+			file_flag = false;
+		}
+		else if (strcmp("-dasm",argv[i]) == 0) {
+			dasm_flag = true;
+		}
+		else if (strcmp("-nodasm",argv[i]) == 0) {
+			dasm_flag = false;
+		}
+		else if (strcmp("-trace",argv[i]) == 0) {
+			trace_flag = true;
+		}
+		else if (strcmp("-notrace",argv[i]) == 0) {
+			trace_flag = false;
+		}
+		else if (strcmp("-func",argv[i]) == 0) {
+			func_flag = true;
+		}
+		else if (strcmp("-nofunc",argv[i]) == 0) {
+			func_flag = false;
+		}
+		else if (strncmp("--strip=",argv[i],strlen("--strip=")) == 0) {
+			strip_flag = argv[i]+strlen("--strip=");
+
+			if (strip_flag[0] == '"') {
+				strip_flag += 1;
+
+				if (strip_flag[strlen(strip_flag)] == '"') {
+					strip_flag[strlen(strip_flag)] = 0;
+				}
+			}
+		}
+		else if (strncmp("-cutpath=",argv[i],strlen("-cutpath=")) == 0) {
+			cutPath = argv[i]+strlen("-cutpath=");
+
+			// see if newRoot is provided
+
+			int i;
+			for (i = 0; (cutPath[i] != 0) && (cutPath[i] != ','); i++) { /* empty */ }
+
+			if (cutPath[i] == ',') {
+				cutPath[i] = 0;
+
+				newRoot = &cutPath[i+1];
+			}
+		}
+		else if (strcmp("-v",argv[i]) == 0) {
+			version_flag = true;
+		}
+		else if (strcmp("-h",argv[i]) == 0) {
+			usage_flag = true;
+		}
+		else if (strcmp("-itcprint",argv[i]) == 0) {
+			itcPrintOpts |= TraceDqr::ITC_OPT_PRINT | TraceDqr::ITC_OPT_NLS;
+			itcPrintChannel = 0;
+		}
+		else if (strncmp("-itcprint=",argv[i],strlen("-itcprint=")) == 0) {
+			int l;
+			char *endptr;
+
+			l = strtol(&argv[i][strlen("-itcprint=")], &endptr, 0);
+
+			if (endptr[0] == 0 ) {
+				itcPrintOpts |= TraceDqr::ITC_OPT_PRINT | TraceDqr::ITC_OPT_NLS;
+				itcPrintChannel = l;
+			}
+			else {
+				itcPrintOpts = false;
+				fprintf(out,"Error: option -itcprint= requires a valid number 0 - 31\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp("-noitcprint",argv[i]) == 0) {
+			itcPrintOpts &= ~TraceDqr::ITC_OPT_PRINT;
+		}
+		else if (strcmp("-nls",argv[i]) == 0) {
+			itcPrintOpts |= TraceDqr::ITC_OPT_NLS;
+		}
+		else if (strcmp("-nonls",argv[i]) == 0) {
+			itcPrintOpts &= ~TraceDqr::ITC_OPT_NLS;
+		}
+		else if (strcmp("-32",argv[i]) == 0) {
+			numAddrBits = 32;
+			addrDispFlags = addrDispFlags & ~TraceDqr::ADDRDISP_WIDTHAUTO;
+		}
+		else if (strcmp("-64",argv[i]) == 0) {
+			numAddrBits = 64;
+			addrDispFlags = addrDispFlags & ~TraceDqr::ADDRDISP_WIDTHAUTO;
+		}
+		else if (strcmp("-32+",argv[i]) == 0) {
+			numAddrBits = 32;
+			addrDispFlags = addrDispFlags | TraceDqr::ADDRDISP_WIDTHAUTO;
+		}
+		else if (strncmp("-addrsize=",argv[i],strlen("-addrsize=")) == 0) {
+			int l;
+			char *endptr;
+
+			l = strtol(&argv[i][strlen("-addrsize=")], &endptr, 10);
+
+			if (endptr[0] == 0 ) {
+				numAddrBits = l;
+				addrDispFlags = addrDispFlags  & ~TraceDqr::ADDRDISP_WIDTHAUTO;
+			}
+			else if (endptr[0] == '+') {
+				numAddrBits = l;
+				addrDispFlags = addrDispFlags | TraceDqr::ADDRDISP_WIDTHAUTO;
+			}
+			else {
+				fprintf(out,"Error: option -addressize= requires a valid number <= 32, >= 64\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			if ((l < 32) || (l > 64)) {
+				fprintf(out,"Error: option -addressize= requires a valid number <= 32, >= 64\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp("-addrsep", argv[i]) == 0) {
+			addrDispFlags = addrDispFlags | TraceDqr::ADDRDISP_SEP;
+		}
+		else if (strcmp("-noaddrsep", argv[i]) == 0) {
+			addrDispFlags = addrDispFlags & ~TraceDqr::ADDRDISP_SEP;
+		}
+		else if (strncmp("-srcbits=",argv[i],strlen("-srcbits=")) == 0) {
+			srcbits = atoi(argv[i]+strlen("-srcbits="));
+
+			if ((srcbits < 0) || (srcbits > 8)) {
+				fprintf(out,"Error: option -srcbits=n, n must be a valid number of trace message src bits >= 0, <= 8\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp("-analytics",argv[i]) == 0) {
+			analytics_detail = 1;
+		}
+		else if (strncmp("-analytics=",argv[i],strlen("-analytics=")) == 0) {
+			analytics_detail = atoi(argv[i]+strlen("-analytics="));
+
+			if (analytics_detail < 0) {
+				fprintf(out,"Error: option -analytics=n, n must be a valid number >= 0\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+		}
+		else if (strcmp("-noanalytics",argv[i]) == 0) {
+			analytics_detail = 0;
+		}
+		else if (strcmp("-freq",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -freq requires a clock frequency to be specified\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			freq = atoi(argv[i]);
+			if (freq < 0) {
+				fprintf(out,"Error: clock frequency must be >= 0\n");
+				return 1;
+			}
+		}
+		else if (strncmp("-tssize=",argv[i],strlen("-tssize=")) == 0) {
+			tssize = atoi(argv[i]+strlen("-tssize="));
+
+			if ((tssize <= 0) || (tssize > 64)) {
+				fprintf(out,"Error: tssize must be > 0, <= 64");
+				return 1;
+			}
+		}
+		else if (strcmp("-callreturn",argv[i]) == 0 ) {
+			showCallsReturns = true;
+		}
+		else if (strcmp("-nocallreturn",argv[i]) == 0 ) {
+			showCallsReturns = false;
+		}
+		else if (strcmp("-branches",argv[i]) == 0 ) {
+			showBranches = true;
+		}
+		else if (strcmp("-nobranches",argv[i]) == 0 ) {
+			showBranches = false;
+		}
+		else if (strcmp("-pathunix",argv[i]) == 0) {
+			pt = TraceDqr::PATH_TO_UNIX;
+		}
+		else if (strcmp("-pathwindows",argv[i]) == 0) {
+			pt = TraceDqr::PATH_TO_WINDOWS;
+		}
+		else if (strcmp("-pathraw",argv[i]) == 0) {
+			pt = TraceDqr::PATH_RAW;
+		}
+		else if (strcmp("-s",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -s requires a file name\n");
+				usage(out,argv[0]);
+				return 1;
+			}
+
+			base_name = nullptr;
+			tf_name = nullptr;
+			ef_name = nullptr;
+
+			sf_name = argv[i];
+		}
+		else if (strncmp("-archsize=",argv[i],strlen("-archsize=")) == 0) {
+			archSize = atoi(argv[i]+strlen("-archsize="));
+
+			if ((archSize != 32) && (archSize != 64)) {
+				fprintf(out,"Error: archSize must be 32 or 64\n");
+				return 1;
+			}
+		}
+		else if (strncmp("-msglevel=",argv[i],strlen("-msglevel=")) == 0) {
+			msgLevel = atoi(argv[i]+strlen("-msglevel="));
+
+			if ((msgLevel < 0) || (msgLevel > 3)) {
+				fprintf(out,"Error: msgLevel must be >=0, <= 3\n");
+				return 1;
+			}
+		}
+		else if (strcmp("-r",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: option -r requires an address\n");
+				return 1;
+			}
+
+			if (ef_name == nullptr) {
+				fprintf(out,"option -r requires first specifying the ELF file name (with the -e flag)\n");
+				return 1;
+			}
+
+			ObjFile *of;
+			TraceDqr::DQErr rc;
+
+			of = new ObjFile(ef_name,od_name);
+			rc = of->getStatus();
+			if (rc != TraceDqr::DQERR_OK) {
+				fprintf(out,"Error: cannot create ObjFile object\n");
+				delete of;
+				return 1;
+			}
+
+			while (i < argc) {
+				uint32_t addr;
+				char *endptr;
+
+				addr = strtoul(argv[i],&endptr,0);
+				if (endptr[0] != 0) {
+					fprintf(out,"Error: option -r requires a valid address\n");
+					delete of;
+					return 1;
+				}
+
+				Instruction instInfo;
+				Source srcInfo;
+
+				rc = of->sourceInfo(addr,instInfo,srcInfo);
+				if (rc != TraceDqr::DQERR_OK) {
+					fprintf(out,"Error: cannot get sourceInfo for address 0x%08x\n",addr);
+				}
+				else {
+					fprintf(out,"For address 0x%08x\n",addr);
+					fprintf(out,"File: %s:%d\n",srcInfo.sourceFile,srcInfo.sourceLineNum);
+					fprintf(out,"Function: %s\n",srcInfo.sourceFunction);
+					fprintf(out,"Src: %s\n",srcInfo.sourceLine);
+
+					fprintf(out,"Label: %s+0x%08x\n",instInfo.addressLabel,instInfo.addressLabelOffset);
+				}
+				i += 1;
+			}
+
+			delete of;
+
+			return 0;
+		}
+		else if (strcmp("-catype",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: -catype flag requires a CA Trace type (none, instruction, or vector)\n");
+				return 1;
+			}
+			if (strcmp("none",argv[i]) == 0) {
+				caType = TraceDqr::CATRACE_NONE;
+				ca_name = nullptr;
+			}
+			else if (strcmp("instruction",argv[i]) == 0) {
+				caType = TraceDqr::CATRACE_INSTRUCTION;
+			}
+			else if (strcmp("vector",argv[i]) == 0) {
+				caType = TraceDqr::CATRACE_VECTOR;
+			}
+			else {
+				fprintf(out,"Error: CA Trace type must be either none, instruction, or vector\n");
+				return 1;
+			}
+		}
+		else if (strcmp("-allowerrors",argv[i]) == 0) {
+			allowErrors = true;
+		}
+		else if (strcmp("-noallowerrors",argv[i]) == 0) {
+			allowErrors = false;
+		}
+		else if (strcmp("-o",argv[i]) == 0) {
+			// the output file is opened by runDecode()
+
+			i += 1;
+		}
+		else if (strcmp("-p",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: -p flag require a PCD file name\n");
+				return 1;
+			}
+
+			vf_name = argv[i];
+		}
+		else if (strcmp("-bin",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: -bin flag requires a file name\n");
+				return 1;
+			}
+
+			bin_name = argv[i];
+		}
+		else if (strcmp("-col",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: -col flag requires a file name\n");
+				return 1;
+			}
+
+			col_name = argv[i];
+		}
+		else if (strcmp("-bintotext",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: -bintotext flag requires a file name\n");
+				return 1;
+			}
+
+			bintotext_name = argv[i];
+		}
+		else if (strcmp("-coltotext",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				fprintf(out,"Error: -coltotext flag requires a file name\n");
+				return 1;
+			}
+
+			coltotext_name = argv[i];
+		}
+		else {
+			fprintf(out,"Unkown option '%s'\n",argv[i]);
+			usage_flag = true;
+		}
+	}
+
+	if (usage_flag) {
+		usage(out,argv[0]);
+		return 0;
+	}
+
+	if (version_flag) {
+		fprintf(out,"%s: version %s\n",argv[0],Trace::version());
+		return 0;
+	}
+
+	if (bintotext_name != nullptr) {
+		return binToText(bintotext_name,out,src_flag,file_flag,dasm_flag,func_flag,showBranches,showCallsReturns,strip_flag);
+	}
+
+	if (coltotext_name != nullptr) {
+		return colToText(coltotext_name,out);
+	}
+
+	if (base_name != nullptr) {
+		tf_name = &buff[buff_index];
+		strcpy(tf_name,base_name);
+		strcat(tf_name,".rtd");
+		buff_index += strlen(tf_name) + 1;
+
+		ef_name = &buff[buff_index];
+		strcpy(ef_name,base_name);
+		strcat(ef_name,".elf");
+		buff_index += strlen(ef_name) + 1;
+	}
+
+	Trace *trace = nullptr;
+	Simulator *sim = nullptr;
+	VCD *vcd = nullptr;
+
+	int numPids;
+	pidMap *pidMap = nullptr;
+        uint32_t currentPid = 0xffffffff;
+        char *currentPidName = nullptr;
+
+	if (sf_name != nullptr) {
+		if ( ef_name == nullptr) {
+			fprintf(out,"Error: Simulator requires an ELF file (-e switch)\n");
+
+			return 1;
+		}
+
+		sim = new (std::nothrow) Simulator(sf_name,ef_name,od_name);
+		if (sim == nullptr) {
+			fprintf(out,"Error: Could not create Simulator object\n");
+			return 1;
+		}
+
+		if (sim->getStatus() != TraceDqr::DQERR_OK) {
+			delete sim;
+			sim = nullptr;
+			fprintf(out,"Error: new Simulator(%s,%d) failed\n",sf_name,archSize);
+
+			return 1;
+		}
+
+		if (cutPath != nullptr) {
+			TraceDqr::DQErr rc;
+
+			rc = sim->subSrcPath(cutPath,newRoot);
+			if (rc != TraceDqr::DQERR_OK) {
+				fprintf(out,"Error: Could not set cutPath or newRoot\n");
+				return 1;
+			}
+		}
+
+		srcbits = 1;
+	}
+	else if ((vf_name != nullptr) || (traceType == TraceDqr::TRACETYPE_VCD)) {
+		if (pf_name != nullptr) {
+			vcd = new (std::nothrow) VCD(pf_name);
+			if (vcd == nullptr) {
+				fprintf(out,"Error: Could not create VCD object\n");
+				return 1;
+			}
+
+			if (vcd->getStatus() != TraceDqr::DQERR_OK) {
+				delete vcd;
+				vcd = nullptr;
+				fprintf(out,"Error: new VCD(%s) failed\n",pf_name);
+
+				return 1;
+			}
+		}
+		else {
+			if ( ef_name == nullptr) {
+				fprintf(out,"Error: -vf switch also requires an ELF file (-e switch)\n");
+
+				return 1;
+			}
+
+			vcd = new (std::nothrow) VCD(vf_name,ef_name,od_name);
+			if (vcd == nullptr) {
+				fprintf(out,"Error: Could not create VCD object\n");
+				return 1;
+			}
+
+			if (vcd->getStatus() != TraceDqr::DQERR_OK) {
+				delete vcd;
+				vcd = nullptr;
+				fprintf(out,"Error: new VCD(%s,%s,%s) failed\n",vf_name,ef_name,od_name);
+
+				return 1;
+			}
+
+			if (cutPath != nullptr) {
+				TraceDqr::DQErr rc;
+
+				rc = vcd->subSrcPath(cutPath,newRoot);
+				if (rc != TraceDqr::DQERR_OK) {
+					fprintf(out,"Error: Could not set cutPath or newRoot\n");
+					return 1;
+				}
+			}
+		}
+
+		srcbits = 1;
+	}
+	else if ((pf_name != nullptr) || (tf_name != nullptr) || (traceType == TraceDqr::TRACETYPE_BTM) || (traceType == TraceDqr::TRACETYPE_HTM) || (traceType == TraceDqr::TRACETYPE_HTMNOOPT)) {
+		TraceDqr::DQErr rc;
+
+		if (pf_name != nullptr) {
+			// generate error message if anything was set to not-default!
+
+			if (tf_name != nullptr) {
+				fprintf(out,"Error: cannot specify -t flag when -pf is also specified\n");
+				return 1;
+			}
+
+			if (ef_name != nullptr) {
+				fprintf(out,"Error: cannot specify -e flag when -pf is also specified\n");
+				return 1;
+			}
+
+			trace = new (std::nothrow) Trace(pf_name);
+
+			if (trace == nullptr) {
+				fprintf(out,"Error: Could not create Trace object\n");
+
+				return 1;
+			}
+
+			if (trace->getStatus() != TraceDqr::DQERR_OK) {
+				delete trace;
+				trace = nullptr;
+
+				fprintf(out,"Error: new Trace() failed\n",pf_name);
+
+				return 1;
+			}
+
+			srcbits = trace->getSrcBits();
+			linuxTrace = trace->isLinuxTrace();
+
+			if (linuxTrace) {
+				pidMap = trace->getPidMap(numPids);
+			}
+		}
+		else {
+			if (tf_name == nullptr) {
+				fprintf(out,"Error: No trace file specified\n");
+				usage(out,argv[0]);
+
+				return 1;
+			}
+			else if (ef_name == nullptr) {
+				fprintf(out,"Error: No elf file specified\n");
+				usage(out,argv[0]);
+
+				 return 1;
+			}
+
+			trace = new (std::nothrow) Trace(tf_name,ef_name,numAddrBits,addrDispFlags,srcbits,od_name,freq);
+
+			if (trace == nullptr) {
+				fprintf(out,"Error: Could not create Trace object\n");
+
+				return 1;
+			}
+
+			if (trace->getStatus() != TraceDqr::DQERR_OK) {
+				delete trace;
+				trace = nullptr;
+
+				fprintf(out,"Error: new Trace(%s,%s) failed\n",tf_name,ef_name);
 
-	for (int i = 1; i < argc; i++) {
-		if (strcmp("-t",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -t requires a file name\n");
-				usage(argv[0]);
 				return 1;
 			}
 
-			base_name = nullptr;
-			sf_name = nullptr;
+			trace->setTraceType(traceType);
+
+			trace->setErrorMode(allowErrors);
+
+			if (ca_name != nullptr) {
+				rc = trace->setCATraceFile(ca_name,caType);
+				if (rc != TraceDqr::DQERR_OK) {
+					fprintf(out,"Error: Could not set cycle accurate trace file\n");
+					return 1;
+				}
+			}
+
+			trace->setTSSize(tssize);
+			trace->setPathType(pt);
+
+			if (cutPath != nullptr) {
+				rc = trace->subSrcPath(cutPath,newRoot);
+				if (rc != TraceDqr::DQERR_OK) {
+					fprintf(out,"Error: Could not set cutPath or newRoot\n");
+					return 1;
+				}
+			}
+
+			// NLS is on by default when the trace object is created. Only
+			// set the print options if something has changed
+
+			if (itcPrintOpts != TraceDqr::ITC_OPT_NLS) {
+				trace->setITCPrintOptions(itcPrintOpts,4096,itcPrintChannel);
+			}
+
+			if (ctf_flag != false) {
+				rc = trace->enableCTFConverter(-1,nullptr);
+				if (rc != TraceDqr::DQERR_OK) {
+					fprintf(out,"Error: Could not set CTF file\n");
+					return 1;
+				}
+			}
+
+			linuxTrace = trace->isLinuxTrace();
+
+			if (linuxTrace) {
+				pidMap = trace->getPidMap(numPids);
+			}
+		}
+	}
+	else {
+		fprintf(out,"Error: must specify either simulator file, trace file, SWT trace server, properties file, or base name\n");
+		usage(out,argv[0]);
+		return 1;
+	}
+
+	TraceDqr::DQErr ec;
+
+	// main loop
+
+//	this shouldn't be next instruction. it should be next because we may not be generating instruction'
+//	we may just be dumping raw traces, or we may be dumping traces with addresses or we may be doing
+//	dissasembled instruction traces or we may be adding source code
+//
+//	flags:
+//
+//		raw trace messages
+//		decoded trace message
+//		include trace addresses
+//		include disassembly
+//		include source
+
+	// we want to be able to select the level of output, from minimal (raw trace only) to full (everything)
+
+//	do we select when we create the trace object?
+//	does it always generate as much as possible and we jsut print what we want?
+//
+//	should not print, but should return a string or way to make a string!
+//
+//	should look at source code display!
+
+	Instruction *instInfo;
+	NexusMessage *msgInfo;
+	Source *srcInfo;
+	char dst[10000];
+	int instlevel = 1;
+	const char *lastSrcFile = nullptr;
+	const char *lastSrcLine = nullptr;
+	unsigned int lastSrcLineNum = 0;
+	TraceDqr::ADDRESS lastAddress = 0;
+	int lastInstSize = 0;
+	bool firstPrint = true;
+	uint32_t core_mask = 0;
+	TraceDqr::TIMESTAMP startTime, endTime;
+
+	msgInfo = nullptr;
+
+	if (pidMap != nullptr) {
+		dumpPidMap(out,numPids,pidMap);
+	}
+
+	OutWriter w(out);
+	InstLineCache lineCache;
+	BinTraceWriter *binWriter = nullptr;
+
+	if (bin_name != nullptr) {
+		uint32_t binFlags = 0;
+
+		if (linuxTrace) {
+			binFlags |= BinTrace::flagLinuxTrace;
+		}
+
+		if ((vcd != nullptr) || (sim != nullptr) || (ca_name != nullptr)) {
+			binFlags |= BinTrace::flagTimestamps;
+		}
+
+		binWriter = new BinTraceWriter;
+
+		if (binWriter->open(bin_name,srcbits,binFlags) != TraceDqr::DQERR_OK) {
+			fprintf(out,"Error: cannot create binary trace file %s\n",bin_name);
+			delete binWriter;
+			return 1;
+		}
+	}
+
+	ColTraceWriter *colWriter = nullptr;
+
+	if (col_name != nullptr) {
+		colWriter = new ColTraceWriter;
+
+		if (colWriter->open(col_name) != TraceDqr::DQERR_OK) {
+			fprintf(out,"Error: cannot create columnar trace file %s\n",col_name);
+			delete colWriter;
+			if (binWriter != nullptr) {
+				delete binWriter;
+			}
+			return 1;
+		}
+	}
+
+	// instructions and their source go to the -bin or -col file instead of the listing
+
+	bool listInstructions = (binWriter == nullptr) && (colWriter == nullptr);
+
+	// the library prints its error and info messages to stdout (or the thread's message file). If the listing
+	// goes there too, write out what has been buffered before calling into the library, so the messages come
+	// out next to the instruction or message they are about
+
+	bool sharedOut = (out == Trace::getThreadMessageFile());
+
+	do {
+		if (sharedOut) {
+			w.flush();
+		}
+
+		if (sim != nullptr) {
+			ec = sim->NextInstruction(&instInfo,&srcInfo);
+		}
+		else if (vcd != nullptr) {
+			ec = vcd->NextInstruction(&instInfo,&srcInfo);
+		}
+		else {
+			ec = trace->NextInstruction(&instInfo,&msgInfo,&srcInfo);
+
+			if (pidMap != nullptr) {
+				if (instInfo != nullptr) {
+					if (currentPid != instInfo->pid) {
+						currentPid = instInfo->pid;
+					}
+				}
+				else if (msgInfo != nullptr) {
+					if (currentPid != msgInfo->pid) {
+						currentPid = msgInfo->pid;
+					}
+				}
+				else if (srcInfo != nullptr) {
+					if (currentPid != srcInfo->pid) {
+						currentPid = srcInfo->pid;
+					}
+				}
+
+				currentPidName = nullptr;
+
+				for (int i = 0; (currentPidName == nullptr) && (i < numPids); i++) {
+					if (pidMap[i].pid == currentPid) {
+						currentPidName = &pidMap[i].name[pidMap[i].shortNameIndex];
+					}
+				}
+			}
+		}
+
+		// Don't check ec here. Check at bottom of loop. There can still be valid info returned from NextInstruction
+
+//		if (ec == TraceDqr::DQERR_OK) {
+			if (binWriter != nullptr) {
+				if (binWriter->addInstruction(instInfo,srcInfo) != TraceDqr::DQERR_OK) {
+					ec = binWriter->getStatus();
+				}
+			}
+
+			if (colWriter != nullptr) {
+				if (colWriter->addInstruction(instInfo,srcInfo) != TraceDqr::DQERR_OK) {
+					ec = colWriter->getStatus();
+				}
+			}
+
+			if (listInstructions && (srcInfo != nullptr)) {
+				if ((lastSrcFile != srcInfo->sourceFile) || (lastSrcLine != srcInfo->sourceLine) || (lastSrcLineNum != srcInfo->sourceLineNum)) {
+					lastSrcFile = srcInfo->sourceFile;
+					lastSrcLine = srcInfo->sourceLine;
+					lastSrcLineNum = srcInfo->sourceLineNum;
+
+					if (file_flag) {
+						if (srcInfo->sourceFile != nullptr) {
+							if (firstPrint == false) {
+								w.put('\n');
+							}
+
+							putContext(w,linuxTrace,srcbits,srcInfo->coreId,currentPid,srcInfo->prv,currentPidName);
+							putFileLine(w,srcInfo,strip_flag);
+
+							firstPrint = false;
+						}
+					}
+
+					if (src_flag) {
+						if (srcInfo->sourceLine != nullptr) {
+							putContext(w,linuxTrace,srcbits,srcInfo->coreId,currentPid,srcInfo->prv,currentPidName);
+
+							w.put("Source: ");
+							w.put(srcInfo->sourceLine);
+							w.put('\n');
+
+							firstPrint = false;
+						}
+					}
+				}
+			}
+
+			if (listInstructions && dasm_flag && (instInfo != nullptr)) {
+				if (func_flag) {
+					if (((instInfo->addressLabel != nullptr) && (instInfo->addressLabelOffset == 0)) || (instInfo->address != (lastAddress + lastInstSize / 8))) {
+						if (instInfo->addressLabel != nullptr) {
+							putContext(w,linuxTrace,srcbits,instInfo->coreId,currentPid,instInfo->prv,currentPidName);
+
+							w.put('<');
+							w.put(instInfo->addressLabel);
+							if (instInfo->addressLabelOffset != 0) {
+								w.put('+');
+								w.putHex((uint32_t)instInfo->addressLabelOffset,0);
+							}
+							w.put(">\n");
+						}
+					}
+
+					lastAddress = instInfo->address;
+					lastInstSize = instInfo->instSize;
+				}
+
+				putContext(w,linuxTrace,srcbits,instInfo->coreId,currentPid,instInfo->prv,currentPidName);
+
+				if (((vcd != nullptr) || (sim != nullptr) || (ca_name != nullptr)) && (instInfo->timestamp != 0)) {
+					uint64_t start = w.getCount();
+
+					w.put("t:");
+					w.putDec((int)instInfo->timestamp);
+					w.put(' ');
+
+					if (instInfo->caFlags & (TraceDqr::CAFLAG_PIPE0 | TraceDqr::CAFLAG_PIPE1)) {
+						if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE0) {
+							w.put("[0:");
+							w.putDec((int)instInfo->pipeCycles);
+						}
+						else if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE1) {
+							w.put("[1:");
+							w.putDec((int)instInfo->pipeCycles);
+						}
+
+						if (instInfo->caFlags & TraceDqr::CAFLAG_VSTART) {
+							w.put('(');
+							w.putDec(instInfo->qDepth);
+							w.put(")-");
+							w.putDec((int)instInfo->VIStartCycles);
+							w.put('(');
+							w.putDec(instInfo->arithInProcess);
+							w.put("A,");
+							w.putDec(instInfo->loadInProcess);
+							w.put("L,");
+							w.putDec(instInfo->storeInProcess);
+							w.put("S)");
+						}
+
+						if (instInfo->caFlags & TraceDqr::CAFLAG_VARITH) {
+							w.put('-');
+							w.putDec((int)instInfo->VIFinishCycles);
+							w.put('A');
+						}
 
-			tf_name = argv[i];
-		}
-		else if (strcmp("-n",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -n requires a file name\n");
-				usage(argv[0]);
-				return 1;
-			}
+						if (instInfo->caFlags & TraceDqr::CAFLAG_VLOAD) {
+							w.put('-');
+							w.putDec((int)instInfo->VIFinishCycles);
+							w.put('L');
+						}
 
-			ef_name = nullptr;
-			tf_name = nullptr;
-			sf_name = nullptr;
+						if (instInfo->caFlags & TraceDqr::CAFLAG_VSTORE) {
+							w.put('-');
+							w.putDec((int)instInfo->VIFinishCycles);
+							w.put('S');
+						}
 
-			base_name = argv[i];
-		}
-		else if (strcmp("-e",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -e requires a file name\n");
-				usage(argv[0]);
-				return 1;
-			}
+						w.put("] ");
+					}
 
-			base_name = nullptr;
+					w.pad(start,14);
+				}
+				else if (vcd != nullptr) {
+					if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE0) {
+						w.put("[0]");
+					}
+					else if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE1) {
+						w.put("[1]");
+					}
+					else {
+						w.put("[?]");
+					}
+				}
 
-			ef_name = argv[i];
-		}
-		else if (strcmp("-sf",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -sf requires a file name\n");
-				usage(argv[0]);
-				return 1;
-			}
+				lineCache.put(w,instInfo,instlevel);
 
-			pf_name = argv[i];
-		}
-		else if (strcmp("-ca",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -ca requires a file name\n");
-				usage(argv[0]);
-				return 1;
-			}
+				putInstFlags(w,instInfo,showBranches,showCallsReturns);
 
-			ca_name = argv[i];
-		}
-		else if (strcmp("-od",argv[i]) == 0) {
-			i += 1;
-			if (i > argc) {
-				printf("Error: option -od requires a file name/path\n");
-				usage(argv[0]);
-				return 1;
+				w.put('\n');
+
+				firstPrint = false;
 			}
 
-			od_name = argv[i];
-		}
-		else if (strcmp("-ctf",argv[i]) == 0) {
-			ctf_flag = true;
-		}
-		else if (strcmp("-noctf",argv[i]) == 0) {
-			ctf_flag = false;
-		}
-		else if (strcmp("-btm",argv[i]) == 0) {
-			traceType = TraceDqr::TRACETYPE_BTM;
-		}
-		else if (strcmp("-htm",argv[i]) == 0) {
-			traceType = TraceDqr::TRACETYPE_HTM;
-		}
-		else if (strcmp("-htmnoopt",argv[i]) == 0) {
-			traceType = TraceDqr::TRACETYPE_HTMNOOPT;
-		}
-		else if (strcmp("-event",argv[i]) == 0) {
-			traceType = TraceDqr::TRACETYPE_EVENT;
-		}
-		else if (strcmp("-pathprofiler",argv[i]) == 0) {
-			traceType = TraceDqr::TRACETYPE_PATH;
-		}
-		else if (strcmp("-pcd",argv[i]) == 0) {
-			traceType = TraceDqr::TRACETYPE_VCD;
-		}
-		else if (strcmp("-src",argv[i]) == 0) {
-			src_flag = true;
-		}
-		else if (strcmp("-nosrc",argv[i]) == 0) {
-			src_flag = false;
-		}
-		else if (strcmp("-file",argv[i]) == 0) {
-			file_flag = true;
-		}
-		else if (strcmp("-nofile",argv[i]) == 0) {
-			file_flag = false;
-		}
-		else if (strcmp("-dasm",argv[i]) == 0) {
-			dasm_flag = true;
-		}
-		else if (strcmp("-nodasm",argv[i]) == 0) {
-			dasm_flag = false;
-		}
-		else if (strcmp("-trace",argv[i]) == 0) {
-			trace_flag = true;
-		}
-		else if (strcmp("-notrace",argv[i]) == 0) {
-			trace_flag = false;
-		}
-		else if (strcmp("-func",argv[i]) == 0) {
-			func_flag = true;
-		}
-		else if (strcmp("-nofunc",argv[i]) == 0) {
-			func_flag = false;
-		}
-		else if (strncmp("--strip=",argv[i],strlen("--strip=")) == 0) {
-			strip_flag = argv[i]+strlen("--strip=");
+			if ((trace != nullptr) && trace_flag && (msgInfo != nullptr)) {
+				// got the goods! Get to it!
 
-			if (strip_flag[0] == '"') {
-				strip_flag += 1;
+				if (globalDebugFlag) {
+					w.flush();
+					msgInfo->dumpRawMessage();
+				}
 
-				if (strip_flag[strlen(strip_flag)] == '"') {
-					strip_flag[strlen(strip_flag)] = 0;
+				msgInfo->messageToText(dst,sizeof dst,msgLevel);
+
+				if (firstPrint == false) {
+					w.put('\n');
 				}
+
+				putContext(w,linuxTrace,srcbits,msgInfo->coreId,currentPid,msgInfo->prv,currentPidName);
+
+				w.put("Trace: ");
+				w.put(dst);
+				w.put('\n');
+
+				firstPrint = false;
 			}
-		}
-		else if (strncmp("-cutpath=",argv[i],strlen("-cutpath=")) == 0) {
-			cutPath = argv[i]+strlen("-cutpath=");
 
-			// see if newRoot is provided
+			if ((trace != nullptr) && (itcPrintOpts != TraceDqr::ITC_OPT_NONE)) {
+				std::string s;
+				bool haveStr;
 
-			int i;
-			for (i = 0; (cutPath[i] != 0) && (cutPath[i] != ','); i++) { /* empty */ }
+				core_mask = trace->getITCPrintMask();
 
-			if (cutPath[i] == ',') {
-				cutPath[i] = 0;
+				for (int core = 0; core_mask != 0; core++) {
+					if (core_mask & 1) {
+						s = trace->getITCPrintStr(core,haveStr,startTime,endTime);
+						while (haveStr != false) {
+							if (firstPrint == false) {
+								w.put('\n');
+							}
 
-				newRoot = &cutPath[i+1];
+							putContext(w,linuxTrace,srcbits,msgInfo->coreId,currentPid,msgInfo->prv,currentPidName);
+
+							w.put("ITC Print: ");
+
+							if ((startTime != 0) || (endTime != 0)) {
+								w.put("Msg Tics: <");
+								w.putUDec(startTime);
+								w.put('-');
+								w.putUDec(endTime);
+								w.put("> ");
+							}
+
+							w.put(s.c_str(),s.size());
+
+							firstPrint = false;
+
+							s = trace->getITCPrintStr(core,haveStr,startTime,endTime);
+						}
+					}
+
+					core_mask >>= 1;
+				}
 			}
+//		}
+	} while (ec == TraceDqr::DQERR_OK);
+
+	// the rest of the output is written to out directly
+
+	w.flush();
+
+	if (binWriter != nullptr) {
+		if (binWriter->close() != TraceDqr::DQERR_OK) {
+			fprintf(out,"Error: cannot write binary trace file %s\n",bin_name);
+			ec = binWriter->getStatus();
 		}
-		else if (strcmp("-v",argv[i]) == 0) {
-			version_flag = true;
-		}
-		else if (strcmp("-h",argv[i]) == 0) {
-			usage_flag = true;
+
+		delete binWriter;
+		binWriter = nullptr;
+	}
+
+	if (colWriter != nullptr) {
+		if (colWriter->close() != TraceDqr::DQERR_OK) {
+			fprintf(out,"Error: cannot write columnar trace file %s\n",col_name);
+			ec = colWriter->getStatus();
 		}
-		else if (strcmp("-itcprint",argv[i]) == 0) {
-			itcPrintOpts |= TraceDqr::ITC_OPT_PRINT | TraceDqr::ITC_OPT_NLS;
-			itcPrintChannel = 0;
+
+		delete colWriter;
+		colWriter = nullptr;
+	}
+
+	if (ec == TraceDqr::DQERR_EOF) {
+		if (firstPrint == false) {
+			fprintf(out,"\n");
 		}
-		else if (strncmp("-itcprint=",argv[i],strlen("-itcprint=")) == 0) {
-			int l;
-			char *endptr;
+		fprintf(out,"End of Trace File\n");
+	}
+	else {
+		fprintf(out,"Error (%d) terminated trace decode\n",ec);
 
-			l = strtol(&argv[i][strlen("-itcprint=")], &endptr, 0);
+		// deleting the trace closes its converters, so the perf records they are still holding are written out
 
-			if (endptr[0] == 0 ) {
-				itcPrintOpts |= TraceDqr::ITC_OPT_PRINT | TraceDqr::ITC_OPT_NLS;
-				itcPrintChannel = l;
-			}
-			else {
-				itcPrintOpts = false;
-				printf("Error: option -itcprint= requires a valid number 0 - 31\n");
-				usage(argv[0]);
-				return 1;
+		if (trace != nullptr) {
+			delete trace;
+			trace = nullptr;
+
+			if (pidMap != nullptr) {
+				delete [] pidMap;
+				pidMap = nullptr;
 			}
 		}
-		else if (strcmp("-noitcprint",argv[i]) == 0) {
-			itcPrintOpts &= ~TraceDqr::ITC_OPT_PRINT;
-		}
-		else if (strcmp("-nls",argv[i]) == 0) {
-			itcPrintOpts |= TraceDqr::ITC_OPT_NLS;
-		}
-		else if (strcmp("-nonls",argv[i]) == 0) {
-			itcPrintOpts &= ~TraceDqr::ITC_OPT_NLS;
-		}
-		else if (strcmp("-32",argv[i]) == 0) {
-			numAddrBits = 32;
-			addrDispFlags = addrDispFlags & ~TraceDqr::ADDRDISP_WIDTHAUTO;
-		}
-		else if (strcmp("-64",argv[i]) == 0) {
-			numAddrBits = 64;
-			addrDispFlags = addrDispFlags & ~TraceDqr::ADDRDISP_WIDTHAUTO;
+
+		if (sim != nullptr) {
+			delete sim;
+			sim = nullptr;
 		}
-		else if (strcmp("-32+",argv[i]) == 0) {
-			numAddrBits = 32;
-			addrDispFlags = addrDispFlags | TraceDqr::ADDRDISP_WIDTHAUTO;
+
+		if (vcd != nullptr) {
+			delete vcd;
+			vcd = nullptr;
 		}
-		else if (strncmp("-addrsize=",argv[i],strlen("-addrsize=")) == 0) {
-			int l;
-			char *endptr;
 
-			l = strtol(&argv[i][strlen("-addrsize=")], &endptr, 10);
+		return 1;
+	}
+
+	if ((trace != nullptr) && (itcPrintOpts != TraceDqr::ITC_OPT_NONE)) {
+		std::string s = "";
+		bool haveStr;
+
+		core_mask = trace->getITCFlushMask();
+
+		for (int core = 0; core_mask != 0; core++) {
+			if (core_mask & 1) {
+				s = trace->flushITCPrintStr(core,haveStr,startTime,endTime);
+				while (haveStr != false) {
+					if (firstPrint == false) {
+						fprintf(out,"\n");
+					}
+
+					if (srcbits > 0) {
+						fprintf(out,"[%d] ",core);
+					}
+
+					fprintf(out,"ITC Print: ");
+
+					if ((startTime != 0) || (endTime != 0)) {
+						fprintf(out,"Msg Tics: <%llu-%llu> ",startTime,endTime);
+					}
+
+					fprintf(out,"%s",s.c_str());
+
+					firstPrint = false;
 
-			if (endptr[0] == 0 ) {
-				numAddrBits = l;
-				addrDispFlags = addrDispFlags  & ~TraceDqr::ADDRDISP_WIDTHAUTO;
-			}
-			else if (endptr[0] == '+') {
-				numAddrBits = l;
-				addrDispFlags = addrDispFlags | TraceDqr::ADDRDISP_WIDTHAUTO;
-			}
-			else {
-				printf("Error: option -addressize= requires a valid number <= 32, >= 64\n");
-				usage(argv[0]);
-				return 1;
+					s = trace->flushITCPrintStr(core,haveStr,startTime,endTime);
+				}
 			}
 
-			if ((l < 32) || (l > 64)) {
-				printf("Error: option -addressize= requires a valid number <= 32, >= 64\n");
-				usage(argv[0]);
-				return 1;
-			}
-		}
-		else if (strcmp("-addrsep", argv[i]) == 0) {
-			addrDispFlags = addrDispFlags | TraceDqr::ADDRDISP_SEP;
-		}
-		else if (strcmp("-noaddrsep", argv[i]) == 0) {
-			addrDispFlags = addrDispFlags & ~TraceDqr::ADDRDISP_SEP;
+			core_mask >>= 1;
 		}
-		else if (strncmp("-srcbits=",argv[i],strlen("-srcbits=")) == 0) {
-			srcbits = atoi(argv[i]+strlen("-srcbits="));
+	}
 
-			if ((srcbits < 0) || (srcbits > 8)) {
-				printf("Error: option -srcbits=n, n must be a valid number of trace message src bits >= 0, <= 8\n");
-				usage(argv[0]);
-				return 1;
+	if (analytics_detail > 0) {
+		if (trace != nullptr) {
+			trace->analyticsToText(dst,sizeof dst,analytics_detail);
+			if (firstPrint == false) {
+				fprintf(out,"\n");
 			}
+			firstPrint = false;
+			fprintf(out,"%s",dst);
 		}
-		else if (strcmp("-analytics",argv[i]) == 0) {
-			analytics_detail = 1;
-		}
-		else if (strncmp("-analytics=",argv[i],strlen("-analytics=")) == 0) {
-			analytics_detail = atoi(argv[i]+strlen("-analytics="));
-
-			if (analytics_detail < 0) {
-				printf("Error: option -analytics=n, n must be a valid number >= 0\n");
-				usage(argv[0]);
-				return 1;
+		if (sim != nullptr) {
+			sim->analyticsToText(dst,sizeof dst,analytics_detail);
+			if (firstPrint == false) {
+				fprintf(out,"\n");
 			}
+			firstPrint = false;
+			fprintf(out,"%s",dst);
 		}
-		else if (strcmp("-noanalytics",argv[i]) == 0) {
-			analytics_detail = 0;
+	}
+
+	if (trace != nullptr) {
+		delete trace;
+		trace = nullptr;
+
+		if (pidMap != nullptr) {
+			delete [] pidMap;
+			pidMap = nullptr;
 		}
-		else if (strcmp("-freq",argv[i]) == 0) {
+	}
+
+	if (sim != nullptr) {
+		delete sim;
+		sim = nullptr;
+	}
+
+	if (vcd != nullptr) {
+		delete vcd;
+		vcd = nullptr;
+	}
+
+	return 0;
+}
+
+// runDecode(): run one decode. Output goes to the file given with -o, or stdout if there is no -o
+
+static int runDecode(int argc,char *argv[])
+{
+	const char *of_name = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp("-o",argv[i]) == 0) {
 			i += 1;
 			if (i >= argc) {
-				printf("Error: option -freq requires a clock frequency to be specified\n");
-				usage(argv[0]);
+				printf("Error: option -o requires a file name\n");
+				usage(stdout,argv[0]);
 				return 1;
 			}
 
-			freq = atoi(argv[i]);
-			if (freq < 0) {
-				printf("Error: clock frequency must be >= 0\n");
-				return 1;
-			}
+			of_name = argv[i];
 		}
-		else if (strncmp("-tssize=",argv[i],strlen("-tssize=")) == 0) {
-			tssize = atoi(argv[i]+strlen("-tssize="));
+	}
 
-			if ((tssize <= 0) || (tssize > 64)) {
-				printf("Error: tssize must be > 0, <= 64");
-				return 1;
-			}
-		}
-		else if (strcmp("-callreturn",argv[i]) == 0 ) {
-			showCallsReturns = true;
-		}
-		else if (strcmp("-nocallreturn",argv[i]) == 0 ) {
-			showCallsReturns = false;
-		}
-		else if (strcmp("-branches",argv[i]) == 0 ) {
-			showBranches = true;
+	FILE *out = stdout;
+
+	if (of_name != nullptr) {
+		out = fopen(of_name,"w");
+		if (out == nullptr) {
+			printf("Error: Could not open output file %s\n",of_name);
+			return 1;
 		}
-		else if (strcmp("-nobranches",argv[i]) == 0 ) {
-			showBranches = false;
+	}
+
+	int rc;
+
+	rc = decode(argc,argv,out);
+
+	if (out != stdout) {
+		fclose(out);
+	}
+
+	return rc;
+}
+
+// batch decode: each line of the batch file holds the options for one decode (the same options as
+// the command line, plus -o for the output file). Options given on the command line with -batch are
+// used for every job, and can be overridden by the job. Jobs run in parallel and share elf files
+
+struct batchJob {
+	int    line;
+	char  *args;	// the job's copy of the option strings; argv points into it
+	int    argc;
+	char **argv;
+	int    rc;
+};
+
+#define BATCH_MAXLINE	4096
+#define BATCH_MAXARGS	256
+
+static int splitBatchLine(char *line,char **args,int maxArgs)
+{
+	int n = 0;
+	char *s = line;
+
+	for (;;) {
+		while ((*s == ' ') || (*s == '\t') || (*s == '\r') || (*s == '\n')) {
+			s += 1;
 		}
-		else if (strcmp("-pathunix",argv[i]) == 0) {
-			pt = TraceDqr::PATH_TO_UNIX;
+
+		if ((*s == 0) || (*s == '#')) {
+			return n;
 		}
-		else if (strcmp("-pathwindows",argv[i]) == 0) {
-			pt = TraceDqr::PATH_TO_WINDOWS;
+
+		if (n >= maxArgs) {
+			return -1;
 		}
-		else if (strcmp("-pathraw",argv[i]) == 0) {
-			pt = TraceDqr::PATH_RAW;
+
+		if (*s == '"') {
+			s += 1;
+			args[n] = s;
+			while ((*s != 0) && (*s != '"')) {
+				s += 1;
+			}
 		}
-		else if (strcmp("-s",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -s requires a file name\n");
-				usage(argv[0]);
-				return 1;
+		else {
+			args[n] = s;
+			while ((*s != 0) && (*s != ' ') && (*s != '\t') && (*s != '\r') && (*s != '\n')) {
+				s += 1;
 			}
+		}
 
-			base_name = nullptr;
-			tf_name = nullptr;
-			ef_name = nullptr;
+		n += 1;
 
-			sf_name = argv[i];
+		if (*s == 0) {
+			return n;
 		}
-		else if (strncmp("-archsize=",argv[i],strlen("-archsize=")) == 0) {
-			archSize = atoi(argv[i]+strlen("-archsize="));
 
-			if ((archSize != 32) && (archSize != 64)) {
-				printf("Error: archSize must be 32 or 64\n");
-				return 1;
-			}
-		}
-		else if (strncmp("-msglevel=",argv[i],strlen("-msglevel=")) == 0) {
-			msgLevel = atoi(argv[i]+strlen("-msglevel="));
+		*s = 0;
+		s += 1;
+	}
+}
 
-			if ((msgLevel < 0) || (msgLevel > 3)) {
-				printf("Error: msgLevel must be >=0, <= 3\n");
-				return 1;
-			}
-		}
-		else if (strcmp("-r",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: option -r requires an address\n");
-				return 1;
-			}
+// copyJobArgs(): build the argv for one job: the command line options followed by the job's options.
+// decode() changes some option strings in place (-cutpath=, --strip=), so each job gets its own copy of
+// all of them. Returns the buffer holding the strings, which must be deleted along with jobArgv
 
-			if (ef_name == nullptr) {
-				printf("option -r requires first specifying the ELF file name (with the -e flag)\n");
-				return 1;
-			}
+static char *copyJobArgs(int argc,char *argv[],int n,char *args[],char **&jobArgv)
+{
+	size_t size = 0;
 
-			ObjFile *of;
-			TraceDqr::DQErr rc;
+	for (int i = 0; i < argc; i++) {
+		size += strlen(argv[i]) + 1;
+	}
 
-			of = new ObjFile(ef_name,od_name);
-			rc = of->getStatus();
-			if (rc != TraceDqr::DQERR_OK) {
-				printf("Error: cannot create ObjFile object\n");
-				return 1;
-			}
+	for (int i = 0; i < n; i++) {
+		size += strlen(args[i]) + 1;
+	}
 
-			while (i < argc) {
-				uint32_t addr;
-				char *endptr;
+	char *buff = new char [size];
 
-				addr = strtoul(argv[i],&endptr,0);
-				if (endptr[0] != 0) {
-					printf("Error: option -r requires a valid address\n");
-					return 1;
-				}
+	jobArgv = new char *[argc+n+1];
 
-				Instruction instInfo;
-				Source srcInfo;
+	char *s = buff;
 
-				rc = of->sourceInfo(addr,instInfo,srcInfo);
-				if (rc != TraceDqr::DQERR_OK) {
-					printf("Error: cannot get sourceInfo for address 0x%08x\n",addr);
-				}
-				else {
-					printf("For address 0x%08x\n",addr);
-					printf("File: %s:%d\n",srcInfo.sourceFile,srcInfo.sourceLineNum);
-					printf("Function: %s\n",srcInfo.sourceFunction);
-					printf("Src: %s\n",srcInfo.sourceLine);
+	for (int i = 0; i < argc+n; i++) {
+		const char *arg = (i < argc) ? argv[i] : args[i-argc];
 
-					printf("Label: %s+0x%08x\n",instInfo.addressLabel,instInfo.addressLabelOffset);
-				}
-				i += 1;
-			}
+		strcpy(s,arg);
+		jobArgv[i] = s;
+		s += strlen(arg) + 1;
+	}
 
-			return 0;
-		}
-		else if (strcmp("-debug",argv[i]) == 0) {
-			globalDebugFlag = 1;
+	jobArgv[argc+n] = nullptr;
+
+	return buff;
+}
+
+// checkJobArgs(): options that change process wide settings cannot be given per job, because jobs run
+// at the same time. They can be given on the command line instead. Returns the first such option or nullptr
+
+static const char *checkJobArgs(int n,char *args[])
+{
+	for (int i = 0; i < n; i++) {
+		if ((strcmp("-debug",args[i]) == 0) || (strcmp("-nodebug",args[i]) == 0)) {
+			return args[i];
 		}
-		else if (strcmp("-nodebug",argv[i]) == 0) {
-			globalDebugFlag = 0;
+	}
+
+	return nullptr;
+}
+
+// checkRequestArgs(): any local process can connect to the server, so a request may only name the trace, elf,
+// and other files to read and choose how the output looks. Options that write files (-o, -bin, -col, -ctf),
+// run a program (-od, and -sf because a settings file can give objdump), or list other files are refused, and
+// so are the options that change process wide settings. Returns the first option that may not be used, or nullptr
+
+static const char *requestValueOpts[] = {
+	"-t", "-e", "-n", "-s", "-ca", "-catype", "-p", "-freq",
+};
+
+static const char *requestFlagOpts[] = {
+	"-btm", "-htm", "-htmnoopt", "-event", "-pathprofiler", "-pcd", "-src", "-nosrc", "-file", "-nofile",
+	"-dasm", "-nodasm", "-func", "-nofunc", "-trace", "-notrace", "-pathunix", "-pathwindows", "-pathraw",
+	"-itcprint", "-noitcprint", "-nls", "-nonls", "-32", "-32+", "-64", "-addrsep", "-noaddrsep",
+	"-analytics", "-noanalytics", "-callreturn", "-nocallreturn", "-branches", "-nobranches",
+	"-allowerrors", "-noallowerrors", "-v", "-h",
+};
+
+static const char *requestPrefixOpts[] = {
+	"--strip=", "-cutpath=", "-itcprint=", "-addrsize=", "-archsize=", "-srcbits=", "-analytics=",
+	"-tssize=", "-msglevel=",
+};
+
+static const char *checkRequestArgs(int n,char *args[])
+{
+	for (int i = 0; i < n; i++) {
+		// the rest of the request is the addresses to look up
+
+		if (strcmp("-r",args[i]) == 0) {
+			return nullptr;
 		}
-		else if (strcmp("-catype",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: -catype flag requires a CA Trace type (none, instruction, or vector)\n");
-				return 1;
-			}
-			if (strcmp("none",argv[i]) == 0) {
-				caType = TraceDqr::CATRACE_NONE;
-				ca_name = nullptr;
-			}
-			else if (strcmp("instruction",argv[i]) == 0) {
-				caType = TraceDqr::CATRACE_INSTRUCTION;
-			}
-			else if (strcmp("vector",argv[i]) == 0) {
-				caType = TraceDqr::CATRACE_VECTOR;
-			}
-			else {
-				printf("Error: CA Trace type must be either none, instruction, or vector\n");
-				return 1;
+
+		bool ok = false;
+
+		for (size_t j = 0; (ok == false) && (j < sizeof requestValueOpts / sizeof requestValueOpts[0]); j++) {
+			if (strcmp(requestValueOpts[j],args[i]) == 0) {
+				i += 1;
+				ok = true;
 			}
 		}
-		else if (strcmp("-allowerrors",argv[i]) == 0) {
-			allowErrors = true;
-		}
-		else if (strcmp("-noallowerrors",argv[i]) == 0) {
-			allowErrors = false;
-		}
-		else if (strcmp("-p",argv[i]) == 0) {
-			i += 1;
-			if (i >= argc) {
-				printf("Error: -p flag require a PCD file name\n");
-				return 1;
+
+		for (size_t j = 0; (ok == false) && (j < sizeof requestFlagOpts / sizeof requestFlagOpts[0]); j++) {
+			if (strcmp(requestFlagOpts[j],args[i]) == 0) {
+				ok = true;
 			}
+		}
 
-			vf_name = argv[i];
+		for (size_t j = 0; (ok == false) && (j < sizeof requestPrefixOpts / sizeof requestPrefixOpts[0]); j++) {
+			if (strncmp(requestPrefixOpts[j],args[i],strlen(requestPrefixOpts[j])) == 0) {
+				ok = true;
+			}
 		}
-		else {
-			printf("Unkown option '%s'\n",argv[i]);
-			usage_flag = true;
+
+		if (ok == false) {
+			return args[i];
 		}
 	}
 
-	if (usage_flag) {
-		usage(argv[0]);
-		return 0;
-	}
+	return nullptr;
+}
 
-	if (version_flag) {
-		printf("%s: version %s\n",argv[0],Trace::version());
-		return 0;
+static void freeBatchJobs(batchJob *jobs,int numJobs)
+{
+	for (int j = 0; j < numJobs; j++) {
+		delete [] jobs[j].args;
+		delete [] jobs[j].argv;
 	}
 
-	if (base_name != nullptr) {
-		tf_name = &buff[buff_index];
-		strcpy(tf_name,base_name);
-		strcat(tf_name,".rtd");
-		buff_index += strlen(tf_name) + 1;
+	delete [] jobs;
+}
 
-		ef_name = &buff[buff_index];
-		strcpy(ef_name,base_name);
-		strcat(ef_name,".elf");
-		buff_index += strlen(ef_name) + 1;
+static int readBatchFile(const char *bf_name,int argc,char *argv[],batchJob *&jobs,int &numJobs)
+{
+	FILE *bf;
+
+	jobs = nullptr;
+	numJobs = 0;
+
+	bf = fopen(bf_name,"r");
+	if (bf == nullptr) {
+		printf("Error: Could not open batch file %s\n",bf_name);
+		return 1;
 	}
 
-	Trace *trace = nullptr;
-	Simulator *sim = nullptr;
-	VCD *vcd = nullptr;
+	char line[BATCH_MAXLINE];
+	char *args[BATCH_MAXARGS];
+	int maxJobs = 0;
+	int lineNum = 0;
 
-	int numPids;
-	pidMap *pidMap = nullptr;
-        uint32_t currentPid = 0xffffffff;
-        char *currentPidName = nullptr;
+	while (fgets(line,sizeof line,bf) != nullptr) {
+		lineNum += 1;
 
-	if (sf_name != nullptr) {
-		if ( ef_name == nullptr) {
-			printf("Error: Simulator requires an ELF file (-e switch)\n");
+		int l = strlen(line);
 
+		if ((l == sizeof line - 1) && (line[l-1] != '\n')) {
+			printf("Error: %s:%d: line too long\n",bf_name,lineNum);
+			fclose(bf);
+			freeBatchJobs(jobs,numJobs);
+			jobs = nullptr;
+			numJobs = 0;
 			return 1;
 		}
 
-		sim = new (std::nothrow) Simulator(sf_name,ef_name,od_name);
-		if (sim == nullptr) {
-			printf("Error: Could not create Simulator object\n");
-			return 1;
-		}
+		batchJob job;
 
-		if (sim->getStatus() != TraceDqr::DQERR_OK) {
-			delete sim;
-			sim = nullptr;
-			printf("Error: new Simulator(%s,%d) failed\n",sf_name,archSize);
+		job.line = lineNum;
 
+		int n;
+
+		n = splitBatchLine(line,args,BATCH_MAXARGS);
+		if (n <= 0) {
+			if (n == 0) {
+				continue;
+			}
+
+			printf("Error: %s:%d: too many options\n",bf_name,lineNum);
+			fclose(bf);
+			freeBatchJobs(jobs,numJobs);
+			jobs = nullptr;
+			numJobs = 0;
 			return 1;
 		}
 
-		if (cutPath != nullptr) {
-			TraceDqr::DQErr rc;
+		bool haveOutput = false;
 
-			rc = sim->subSrcPath(cutPath,newRoot);
-			if (rc != TraceDqr::DQERR_OK) {
-				printf("Error: Could not set cutPath or newRoot\n");
-				return 1;
+		for (int i = 0; i < n; i++) {
+			if ((strcmp("-o",args[i]) == 0) && (i+1 < n)) {
+				haveOutput = true;
 			}
 		}
 
-		srcbits = 1;
-	}
-	else if ((vf_name != nullptr) || (traceType == TraceDqr::TRACETYPE_VCD)) {
-		if (pf_name != nullptr) {
-			vcd = new (std::nothrow) VCD(pf_name);
-			if (vcd == nullptr) {
-				printf("Error: Could not create VCD object\n");
-				return 1;
-			}
+		if (haveOutput == false) {
+			printf("Error: %s:%d: job does not specify an output file (-o)\n",bf_name,lineNum);
+			fclose(bf);
+			freeBatchJobs(jobs,numJobs);
+			jobs = nullptr;
+			numJobs = 0;
+			return 1;
+		}
 
-			if (vcd->getStatus() != TraceDqr::DQERR_OK) {
-				delete vcd;
-				vcd = nullptr;
-				printf("Error: new VCD(%s) failed\n",pf_name);
+		const char *badOpt = checkJobArgs(n,args);
 
-				return 1;
-			}
+		if (badOpt != nullptr) {
+			printf("Error: %s:%d: option %s cannot be used in a batch job; give it on the command line\n",bf_name,lineNum,badOpt);
+			fclose(bf);
+			freeBatchJobs(jobs,numJobs);
+			jobs = nullptr;
+			numJobs = 0;
+			return 1;
 		}
-		else {
-			if ( ef_name == nullptr) {
-				printf("Error: -vf switch also requires an ELF file (-e switch)\n");
-
-				return 1;
-			}
 
-			vcd = new (std::nothrow) VCD(vf_name,ef_name,od_name);
-			if (vcd == nullptr) {
-				printf("Error: Could not create VCD object\n");
-				return 1;
-			}
+		// argv[0] and the command line options come first so the job's options override them
 
-			if (vcd->getStatus() != TraceDqr::DQERR_OK) {
-				delete vcd;
-				vcd = nullptr;
-				printf("Error: new VCD(%s,%s,%s) failed\n",vf_name,ef_name,od_name);
+		job.argc = argc + n;
+		job.args = copyJobArgs(argc,argv,n,args,job.argv);
+		job.rc = 0;
 
-				return 1;
-			}
+		if (numJobs >= maxJobs) {
+			batchJob *newJobs;
 
-			if (cutPath != nullptr) {
-				TraceDqr::DQErr rc;
+			maxJobs = (maxJobs == 0) ? 64 : maxJobs * 2;
+			newJobs = new batchJob [maxJobs];
 
-				rc = vcd->subSrcPath(cutPath,newRoot);
-				if (rc != TraceDqr::DQERR_OK) {
-					printf("Error: Could not set cutPath or newRoot\n");
-					return 1;
-				}
+			for (int j = 0; j < numJobs; j++) {
+				newJobs[j] = jobs[j];
 			}
+
+			delete [] jobs;
+			jobs = newJobs;
 		}
 
-		srcbits = 1;
+		jobs[numJobs] = job;
+		numJobs += 1;
 	}
-	else if ((pf_name != nullptr) || (tf_name != nullptr) || (traceType == TraceDqr::TRACETYPE_BTM) || (traceType == TraceDqr::TRACETYPE_HTM) || (traceType == TraceDqr::TRACETYPE_HTMNOOPT)) {
-		TraceDqr::DQErr rc;
 
-		if (pf_name != nullptr) {
-			// generate error message if anything was set to not-default!
+	fclose(bf);
 
-			if (tf_name != nullptr) {
-				printf("Error: cannot specify -t flag when -pf is also specified\n");
-				return 1;
-			}
+	return 0;
+}
 
-			if (ef_name != nullptr) {
-				printf("Error: cannot specify -e flag when -pf is also specified\n");
-				return 1;
-			}
+static void batchWorker(batchJob *jobs,int numJobs,std::atomic<int> *nextJob)
+{
+	for (int j = (*nextJob)++; j < numJobs; j = (*nextJob)++) {
+		// each job starts with its own address display settings, not seen by jobs on other threads
 
-			trace = new (std::nothrow) Trace(pf_name);
+		Trace::setThreadDisplaySettings(true);
 
-			if (trace == nullptr) {
-				printf("Error: Could not create Trace object\n");
+		jobs[j].rc = runDecode(jobs[j].argc,jobs[j].argv);
+	}
+}
 
-				return 1;
-			}
+static int runBatch(const char *bf_name,int numThreads,int argc,char *argv[])
+{
+	batchJob *jobs;
+	int numJobs;
 
-			if (trace->getStatus() != TraceDqr::DQERR_OK) {
-				delete trace;
-				trace = nullptr;
+	if (readBatchFile(bf_name,argc,argv,jobs,numJobs) != 0) {
+		return 1;
+	}
 
-				printf("Error: new Trace() failed\n",pf_name);
+	if (numThreads <= 0) {
+		numThreads = std::thread::hardware_concurrency();
+		if (numThreads <= 0) {
+			numThreads = 1;
+		}
+	}
 
-				return 1;
-			}
+	if (numThreads > numJobs) {
+		numThreads = numJobs;
+	}
 
-			srcbits = trace->getSrcBits();
-			linuxTrace = trace->isLinuxTrace();
+	Trace::setElfCaching(true);
 
-			if (linuxTrace) {
-				pidMap = trace->getPidMap(numPids);
-			}
-		}
-		else {
-			if (tf_name == nullptr) {
-				printf("Error: No trace file specified\n");
-				usage(argv[0]);
+	std::atomic<int> nextJob(0);
+	std::thread *threads = nullptr;
 
-				return 1;
-			}
-			else if (ef_name == nullptr) {
-				printf("Error: No elf file specified\n");
-				usage(argv[0]);
+	// this thread is one of the workers
 
-				 return 1;
-			}
+	if (numThreads > 1) {
+		threads = new std::thread[numThreads-1];
 
-			trace = new (std::nothrow) Trace(tf_name,ef_name,numAddrBits,addrDispFlags,srcbits,od_name,freq);
+		for (int t = 0; t < numThreads-1; t++) {
+			threads[t] = std::thread(batchWorker,jobs,numJobs,&nextJob);
+		}
+	}
 
-			if (trace == nullptr) {
-				printf("Error: Could not create Trace object\n");
+	batchWorker(jobs,numJobs,&nextJob);
 
-				return 1;
-			}
+	if (threads != nullptr) {
+		for (int t = 0; t < numThreads-1; t++) {
+			threads[t].join();
+		}
 
-			if (trace->getStatus() != TraceDqr::DQERR_OK) {
-				delete trace;
-				trace = nullptr;
+		delete [] threads;
+		threads = nullptr;
+	}
 
-				printf("Error: new Trace(%s,%s) failed\n",tf_name,ef_name);
+	Trace::setElfCaching(false);
 
-				return 1;
-			}
+	int numFailed = 0;
 
-			trace->setTraceType(traceType);
+	for (int j = 0; j < numJobs; j++) {
+		if (jobs[j].rc != 0) {
+			printf("Error: %s:%d: job failed\n",bf_name,jobs[j].line);
+			numFailed += 1;
+		}
+	}
 
-			trace->setErrorMode(allowErrors);
+	printf("Batch: %d jobs, %d failed\n",numJobs,numFailed);
 
-			if (ca_name != nullptr) {
-				rc = trace->setCATraceFile(ca_name,caType);
-				if (rc != TraceDqr::DQERR_OK) {
-					printf("Error: Could not set cycle accurate trace file\n");
-					return 1;
-				}
-			}
+	freeBatchJobs(jobs,numJobs);
 
-			trace->setTSSize(tssize);
-			trace->setPathType(pt);
+	if (numFailed != 0) {
+		return 1;
+	}
 
-			if (cutPath != nullptr) {
-				rc = trace->subSrcPath(cutPath,newRoot);
-				if (rc != TraceDqr::DQERR_OK) {
-					printf("Error: Could not set cutPath or newRoot\n");
-					return 1;
-				}
-			}
+	return 0;
+}
 
-			// NLS is on by default when the trace object is created. Only
-			// set the print options if something has changed
+// server mode: dqr keeps running and listens for connections on localhost. Each connection sends one
+// line with the options for a decode (the same as a -batch line, without -o), and the output of the
+// decode is sent back on the connection as it is produced. The connection is closed when the decode
+// is done. Elf files stay loaded between requests, so repeated requests for the same elf file (and
+// -r address lookups) do not run objdump again. An elf file is read again if it changes
 
-			if (itcPrintOpts != TraceDqr::ITC_OPT_NLS) {
-				trace->setITCPrintOptions(itcPrintOpts,4096,itcPrintChannel);
-			}
+static void closeSocket(int sock)
+{
+#ifdef WINDOWS
+	closesocket(sock);
+#else // WINDOWS
+	close(sock);
+#endif // WINDOWS
+}
 
-			if (ctf_flag != false) {
-				rc = trace->enableCTFConverter(-1,nullptr);
-				if (rc != TraceDqr::DQERR_OK) {
-					printf("Error: Could not set CTF file\n");
-					return 1;
-				}
-			}
+// readRequest(): read the request line. Anything the client sends after the newline is ignored
 
-			linuxTrace = trace->isLinuxTrace();
+static int readRequest(int sock,char *line,int size)
+{
+	int l = 0;
 
-			if (linuxTrace) {
-				pidMap = trace->getPidMap(numPids);
-			}
-		}
-	}
-	else {
-		printf("Error: must specify either simulator file, trace file, SWT trace server, properties file, or base name\n");
-		usage(argv[0]);
-		return 1;
-	}
+	while (l < size-1) {
+		int rc;
 
-	TraceDqr::DQErr ec;
+		rc = recv(sock,line+l,size-1-l,0);
+		if (rc <= 0) {
+			break;
+		}
 
-	// main loop
+		char *nl = (char*)memchr(line+l,'\n',rc);
+		if (nl != nullptr) {
+			l = nl - line;
+			line[l] = 0;
+			return l;
+		}
 
-//	this shouldn't be next instruction. it should be next because we may not be generating instruction'
-//	we may just be dumping raw traces, or we may be dumping traces with addresses or we may be doing
-//	dissasembled instruction traces or we may be adding source code
-//
-//	flags:
-//
-//		raw trace messages
-//		decoded trace message
-//		include trace addresses
-//		include disassembly
-//		include source
+		l += rc;
+	}
 
-	// we want to be able to select the level of output, from minimal (raw trace only) to full (everything)
+	line[l] = 0;
 
-//	do we select when we create the trace object?
-//	does it always generate as much as possible and we jsut print what we want?
-//
-//	should not print, but should return a string or way to make a string!
-//
-//	should look at source code display!
+	if (l >= size-1) {
+		return -1;
+	}
 
-	Instruction *instInfo;
-	NexusMessage *msgInfo;
-	Source *srcInfo;
-	char dst[10000];
-	int instlevel = 1;
-	const char *lastSrcFile = nullptr;
-	const char *lastSrcLine = nullptr;
-	unsigned int lastSrcLineNum = 0;
-	TraceDqr::ADDRESS lastAddress = 0;
-	int lastInstSize = 0;
-	bool firstPrint = true;
-	uint32_t core_mask = 0;
-	TraceDqr::TIMESTAMP startTime, endTime;
+	return l;
+}
 
-	msgInfo = nullptr;
+static void sendString(int sock,const char *s)
+{
+	send(sock,s,strlen(s),0);
+}
 
-	if (pidMap != nullptr) {
-		dumpPidMap(numPids,pidMap);
+static void serveRequest(int sock,int argc,char **argv)
+{
+	char line[BATCH_MAXLINE];
+	char *args[BATCH_MAXARGS];
+	int n;
+
+	if (readRequest(sock,line,sizeof line) < 0) {
+		sendString(sock,"Error: request too long\n");
+		closeSocket(sock);
+		return;
 	}
 
-	do {
-		if (sim != nullptr) {
-			ec = sim->NextInstruction(&instInfo,&srcInfo);
-		}
-		else if (vcd != nullptr) {
-			ec = vcd->NextInstruction(&instInfo,&srcInfo);
-		}
-		else {
-			ec = trace->NextInstruction(&instInfo,&msgInfo,&srcInfo);
+	n = splitBatchLine(line,args,BATCH_MAXARGS);
+	if (n < 0) {
+		sendString(sock,"Error: too many options\n");
+		closeSocket(sock);
+		return;
+	}
 
-			if (pidMap != nullptr) {
-				if (instInfo != nullptr) {
-					if (currentPid != instInfo->pid) {
-						currentPid = instInfo->pid;
-					}
-				}
-				else if (msgInfo != nullptr) {
-					if (currentPid != msgInfo->pid) {
-						currentPid = msgInfo->pid;
-					}
-				}
-				else if (srcInfo != nullptr) {
-					if (currentPid != srcInfo->pid) {
-						currentPid = srcInfo->pid;
-					}
-				}
+	const char *badOpt = checkRequestArgs(n,args);
 
-				currentPidName = nullptr;
+	if (badOpt != nullptr) {
+		char msg[256];
 
-				for (int i = 0; (currentPidName == nullptr) && (i < numPids); i++) {
-					if (pidMap[i].pid == currentPid) {
-						currentPidName = &pidMap[i].name[pidMap[i].shortNameIndex];
-					}
-				}
-			}
-		}
+		snprintf(msg,sizeof msg,"Error: option %.64s cannot be used in a server request\n",badOpt);
+		sendString(sock,msg);
+		closeSocket(sock);
+		return;
+	}
 
-		// Don't check ec here. Check at bottom of loop. There can still be valid info returned from NextInstruction
+	// argv[0] and the server command line options come first so the request's options override them
 
-//		if (ec == TraceDqr::DQERR_OK) {
-			if (srcInfo != nullptr) {
-				if ((lastSrcFile != srcInfo->sourceFile) || (lastSrcLine != srcInfo->sourceLine) || (lastSrcLineNum != srcInfo->sourceLineNum)) {
-					lastSrcFile = srcInfo->sourceFile;
-					lastSrcLine = srcInfo->sourceLine;
-					lastSrcLineNum = srcInfo->sourceLineNum;
+	int reqArgc = argc + n;
+	char **reqArgv;
+	char *reqArgs;
 
-					if (file_flag) {
-						if (srcInfo->sourceFile != nullptr) {
-							if (firstPrint == false) {
-								printf("\n");
-							}
+	reqArgs = copyJobArgs(argc,argv,n,args,reqArgv);
 
-							const char *sfp;
+	Trace::setThreadDisplaySettings(true);
 
-							sfp = stripPath(strip_flag,srcInfo->sourceFile);
+#ifdef WINDOWS
+	// sockets are not file descriptors on windows, so collect the output and send it when done
 
-							int sfpl = 0;
-							int sfl = 0;
-							int stripped = 0;
+	FILE *out = tmpfile();
+	if (out == nullptr) {
+		sendString(sock,"Error: Could not create temporary file\n");
+	}
+	else {
+		char buff[4096];
+		size_t r;
 
-							if (sfp != srcInfo->sourceFile) {
-								sfpl = strlen(sfp);
-								sfl = strlen(srcInfo->sourceFile);
-								stripped = sfl - sfpl;
-							}
+		Trace::setThreadMessageFile(out);
 
-							if (linuxTrace) {
-								if (currentPidName != nullptr) {
-									printf("[%d.%d.%s:%s] ",srcInfo->coreId,currentPid,prvToTxt(srcInfo->prv),currentPidName);
-								}
-								else if (currentPid == 0xffffffff) {
-									printf("[%d.?.%s] ",srcInfo->coreId,prvToTxt(srcInfo->prv));
-								}
-								else {
-									printf("[%d.%d.%s] ",srcInfo->coreId,currentPid,prvToTxt(srcInfo->prv));
-								}
-							}
-							else if (srcbits > 0) {
-								printf("[%d] ",srcInfo->coreId);
-//linux
-							}
+		decode(reqArgc,reqArgv,out);
 
-							if (stripped < srcInfo->cutPathIndex) {
-								printf("File: [");
+		Trace::setThreadMessageFile(nullptr);
 
-								if (sfp != srcInfo->sourceFile) {
-									printf("..");
-								}
+		rewind(out);
 
-								for (int i = stripped; i < srcInfo->cutPathIndex; i++) {
-									printf("%c",srcInfo->sourceFile[i]);
-								}
+		while ((r = fread(buff,1,sizeof buff,out)) > 0) {
+			if (send(sock,buff,(int)r,0) < 0) {
+				break;
+			}
+		}
 
-								printf("]%s:%d\n",&srcInfo->sourceFile[srcInfo->cutPathIndex],srcInfo->sourceLineNum);
-							}
-							else {
-								if (sfp != srcInfo->sourceFile) {
-									printf("File: ..%s:%d\n",sfp,srcInfo->sourceLineNum);
-								}
-								else {
-									printf("File: %s:%d\n",sfp,srcInfo->sourceLineNum);
-								}
-							}
+		fclose(out);
+	}
 
-							firstPrint = false;
-						}
-					}
+	closesocket(sock);
+#else // WINDOWS
+	FILE *out = fdopen(sock,"w");
+	if (out == nullptr) {
+		sendString(sock,"Error: Could not open connection for output\n");
+		close(sock);
+	}
+	else {
+		// the library messages for the request go back to the client too
 
-					if (src_flag) {
-						if (srcInfo->sourceLine != nullptr) {
-							if (linuxTrace) {
-								if (currentPidName != nullptr) {
-									printf("[%d.%d.%s:%s] ",srcInfo->coreId,currentPid,prvToTxt(srcInfo->prv),currentPidName);
-								}
-								else if (currentPid == 0xffffffff) {
-									printf("[%d.?.%s] ",srcInfo->coreId,prvToTxt(srcInfo->prv));
-								}
-								else {
-									printf("[%d.%d.%s] ",srcInfo->coreId,currentPid,prvToTxt(srcInfo->prv));
-								}
-							}
-							else if (srcbits > 0) {
-								printf("[%d] ",srcInfo->coreId);
-//linux
-							}
+		Trace::setThreadMessageFile(out);
 
-							printf("Source: %s\n",srcInfo->sourceLine);
+		decode(reqArgc,reqArgv,out);
 
-							firstPrint = false;
-						}
-					}
-				}
-			}
+		Trace::setThreadMessageFile(nullptr);
 
-			if (dasm_flag && (instInfo != nullptr)) {
-				instInfo->addressToText(dst,sizeof dst,0);
+		// also closes sock
 
-				if (func_flag) {
-					if (((instInfo->addressLabel != nullptr) && (instInfo->addressLabelOffset == 0)) || (instInfo->address != (lastAddress + lastInstSize / 8))) {
-						if (instInfo->addressLabel != nullptr) {
-							if (linuxTrace) {
-								if (currentPidName != nullptr) {
-									printf("[%d.%d.%s:%s] ",instInfo->coreId,currentPid,prvToTxt(instInfo->prv),currentPidName);
-								}
-								else if (currentPid == 0xffffffff) {
-									printf("[%d.?.%s] ",instInfo->coreId,prvToTxt(instInfo->prv));
-								}
-								else {
-									printf("[%d.%d.%s] ",instInfo->coreId,currentPid,prvToTxt(instInfo->prv));
-								}
-							}
-							else if (srcbits > 0) {
-								printf("[%d] ",instInfo->coreId);
-//linux
-							}
+		fclose(out);
+	}
+#endif // WINDOWS
 
-							printf("<%s",instInfo->addressLabel);
-							if (instInfo->addressLabelOffset != 0) {
-								printf("+%x",instInfo->addressLabelOffset);
-							}
-							printf(">\n");
-						}
-						// else {
-						//	printf("label null\n");
-						// }
-					}
+	delete [] reqArgv;
+	delete [] reqArgs;
+}
 
-					lastAddress = instInfo->address;
-					lastInstSize = instInfo->instSize;
-				}
+// serverQueue: accepted connections waiting for one of the numThreads server workers. New connections
+// are not accepted while the queue is full; they wait in the listen backlog
 
-				if (linuxTrace) {
-					if (currentPidName != nullptr) {
-						printf("[%d.%d.%s:%s] ",instInfo->coreId,currentPid,prvToTxt(instInfo->prv),currentPidName);
-					}
-					else if (currentPid == 0xffffffff) {
-						printf("[%d.?.%s] ",instInfo->coreId,prvToTxt(instInfo->prv));
-					}
-					else {
-						printf("[%d.%d.%s] ",instInfo->coreId,currentPid,prvToTxt(instInfo->prv));
-					}
-				}
-				else if (srcbits > 0) {
-					printf("[%d] ",instInfo->coreId);
-				}
+struct serverQueue {
+	enum { queueSize = 64 };
 
-				int n;
+	std::mutex              lock;
+	std::condition_variable notEmpty;
+	std::condition_variable notFull;
+	int                     socks[queueSize];
+	int                     head;
+	int                     count;
+};
 
-				if (((vcd != nullptr) || (sim != nullptr) || (ca_name != nullptr)) && (instInfo->timestamp != 0)) {
-					n = printf("t:%d ",instInfo->timestamp);
+static void serverWorker(serverQueue *q,int argc,char **argv)
+{
+	for (;;) {
+		int sock;
 
-					if (instInfo->caFlags & (TraceDqr::CAFLAG_PIPE0 | TraceDqr::CAFLAG_PIPE1)) {
-						if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE0) {
-							n += printf("[0:%d",instInfo->pipeCycles);
-						}
-						else if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE1) {
-							n += printf("[1:%d",instInfo->pipeCycles);
-						}
+		{
+			std::unique_lock<std::mutex> guard(q->lock);
 
-						if (instInfo->caFlags & TraceDqr::CAFLAG_VSTART) {
-							n += printf("(%d)-%d(%dA,%dL,%dS)",instInfo->qDepth,instInfo->VIStartCycles,instInfo->arithInProcess,instInfo->loadInProcess,instInfo->storeInProcess);
-																					}
+			while (q->count == 0) {
+				q->notEmpty.wait(guard);
+			}
 
-						if (instInfo->caFlags & TraceDqr::CAFLAG_VARITH) {
-							n += printf("-%dA",instInfo->VIFinishCycles);
-						}
+			sock = q->socks[q->head];
+			q->head = (q->head + 1) % serverQueue::queueSize;
+			q->count -= 1;
+		}
 
-						if (instInfo->caFlags & TraceDqr::CAFLAG_VLOAD) {
-							n += printf("-%dL",instInfo->VIFinishCycles);
-						}
+		q->notFull.notify_one();
 
-						if (instInfo->caFlags & TraceDqr::CAFLAG_VSTORE) {
-							n += printf("-%dS",instInfo->VIFinishCycles);
-						}
+		serveRequest(sock,argc,argv);
+	}
+}
 
-						n += printf("] ");
-					}
+static int runServer(int port,int numThreads,int argc,char *argv[])
+{
+	int rc;
 
-					for (int i = n; i < 14; i++) {
-						printf(" ");
-					}
-				}
-				else if (vcd != nullptr) {
-					if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE0) {
-						n = printf("[0]");
-					}
-					else if (instInfo->caFlags & TraceDqr::CAFLAG_PIPE1) {
-						n = printf("[1]");
-					}
-					else {
-						n = printf("[?]");
-					}
-				}
+#ifdef WINDOWS
+	WORD wVersionRequested;
+	WSADATA wsaData;
 
-				n = printf("    %s:",dst);
+	wVersionRequested = MAKEWORD(2,2);
+	rc = WSAStartup(wVersionRequested,&wsaData);
+	if (rc != 0) {
+		printf("Error: WSAStartUP() failed with error %d\n",rc);
+		return 1;
+	}
+#else // WINDOWS
+	// a client that goes away before its decode is done must not end the server
 
-				for (int i = n; i < 20; i++) {
-					printf(" ");
-				}
+	signal(SIGPIPE,SIG_IGN);
+#endif // WINDOWS
 
-				instInfo->instructionToText(dst,sizeof dst,instlevel);
-				printf("  %s",dst);
-
-				if (showBranches == true) {
-					switch (instInfo->brFlags) {
-					case TraceDqr::BRFLAG_none:
-						break;
-					case TraceDqr::BRFLAG_unknown:
-						printf(" [u]");
-						break;
-					case TraceDqr::BRFLAG_taken:
-						printf(" [t]");
-						break;
-					case TraceDqr::BRFLAG_notTaken:
-						printf(" [nt]");
-						break;
-					}
-				}
+	int serverSock;
 
-				if (showCallsReturns == true) {
-					if (instInfo->CRFlag != TraceDqr::isNone) {
-						const char *format = "%s";
+	serverSock = socket(AF_INET,SOCK_STREAM,0);
+	if (serverSock < 0) {
+		printf("Error: runServer(): socket() failed\n");
+		return 1;
+	}
 
-						printf(" [");
+	int opt = 1;
 
-						if (instInfo->CRFlag & TraceDqr::isCall) {
-							printf(format,"Call");
-							format = ",%s";
-						}
+	setsockopt(serverSock,SOL_SOCKET,SO_REUSEADDR,(const char *)&opt,sizeof opt);
 
-						if (instInfo->CRFlag & TraceDqr::isReturn) {
-							printf(format,"Return");
-							format = ",%s";
-						}
+	struct sockaddr_in serv_addr;
 
-						if (instInfo->CRFlag & TraceDqr::isSwap) {
-							printf(format,"Swap");
-							format = ",%s";
-						}
+	memset((char*)&serv_addr,0,sizeof(serv_addr));
+	serv_addr.sin_family = AF_INET;
+	serv_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	serv_addr.sin_port = htons(port);
 
-						if (instInfo->CRFlag & TraceDqr::isInterrupt) {
-							printf(format,"Interrupt");
-							format = ",%s";
-						}
+	rc = bind(serverSock,(struct sockaddr*)&serv_addr,sizeof(serv_addr));
+	if (rc < 0) {
+		printf("Error: runServer(): Could not bind to port %d\n",port);
+		closeSocket(serverSock);
+		return 1;
+	}
 
-						if (instInfo->CRFlag & TraceDqr::isException) {
-							printf(format,"Exception");
-							format = ",%s";
-						}
+	rc = listen(serverSock,16);
+	if (rc < 0) {
+		printf("Error: runServer(): listen() failed\n");
+		closeSocket(serverSock);
+		return 1;
+	}
 
-						if (instInfo->CRFlag & TraceDqr::isExceptionReturn) {
-							printf(format,"Exception Return");
-							format = ",%s";
-						}
+	if (numThreads <= 0) {
+		numThreads = std::thread::hardware_concurrency();
+		if (numThreads <= 0) {
+			numThreads = 1;
+		}
+	}
 
-						printf("]");
-					}
-				}
+	Trace::setElfCaching(true);
 
-				printf("\n");
+	// a fixed set of workers serve the requests so a long decode does not hold up the others. The
+	// workers run until the process ends
 
-				firstPrint = false;
-			}
+	serverQueue *q = new serverQueue;
 
-			if ((trace != nullptr) && trace_flag && (msgInfo != nullptr)) {
-				// got the goods! Get to it!
+	q->head = 0;
+	q->count = 0;
 
-				if (globalDebugFlag) {
-					msgInfo->dumpRawMessage();
-				}
+	int numStarted = 0;
 
-				msgInfo->messageToText(dst,sizeof dst,msgLevel);
+	for (int t = 0; t < numThreads; t++) {
+		try {
+			std::thread(serverWorker,q,argc,argv).detach();
+		}
+		catch (const std::system_error &e) {
+			break;
+		}
 
-				if (firstPrint == false) {
-					printf("\n");
-				}
+		numStarted += 1;
+	}
 
-				if (linuxTrace) {
-					if (currentPidName != nullptr) {
-						printf("[%d.%d.%s:%s] ",msgInfo->coreId,currentPid,prvToTxt(msgInfo->prv),currentPidName);
-					}
-					else if (currentPid == 0xffffffff) {
-						printf("[%d.?.%s] ",msgInfo->coreId,prvToTxt(msgInfo->prv));
-					}
-					else {
-						printf("[%d.%d.%s] ",msgInfo->coreId,currentPid,prvToTxt(msgInfo->prv));
-					}
-				}
-				else if (srcbits > 0) {
-					printf("[%d] ",msgInfo->coreId);
-//linux
-				}
+	if (numStarted == 0) {
+		printf("Error: runServer(): Could not start any worker threads\n");
+		closeSocket(serverSock);
+		Trace::setElfCaching(false);
+		delete q;
+		return 1;
+	}
 
-				printf("Trace: %s",dst);
+	printf("Server: listening on localhost port %d\n",port);
+	fflush(stdout);
 
-				printf("\n");
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> guard(q->lock);
 
-				firstPrint = false;
+			while (q->count == serverQueue::queueSize) {
+				q->notFull.wait(guard);
 			}
+		}
 
-			if ((trace != nullptr) && (itcPrintOpts != TraceDqr::ITC_OPT_NONE)) {
-				std::string s;
-				bool haveStr;
+		int sock;
 
-				core_mask = trace->getITCPrintMask();
+		sock = accept(serverSock,nullptr,nullptr);
+		if (sock < 0) {
+			continue;
+		}
 
-				for (int core = 0; core_mask != 0; core++) {
-					if (core_mask & 1) {
-						s = trace->getITCPrintStr(core,haveStr,startTime,endTime);
-						while (haveStr != false) {
-							if (firstPrint == false) {
-								printf("\n");
-							}
+		{
+			std::lock_guard<std::mutex> guard(q->lock);
 
-							if (linuxTrace) {
-								if (currentPidName != nullptr) {
-									printf("[%d.%d.%s:%s] ",msgInfo->coreId,currentPid,prvToTxt(msgInfo->prv),currentPidName);
-								}
-								else if (currentPid == 0xffffffff) {
-									printf("[%d.?.%s] ",msgInfo->coreId,prvToTxt(msgInfo->prv));
-								}
-								else {
-									printf("[%d.%d.%s] ",msgInfo->coreId,currentPid,prvToTxt(msgInfo->prv));
-								}
-							}
-							else if (srcbits > 0) {
-								printf("[%d] ",msgInfo->coreId);
-//linux
-							}
+			q->socks[(q->head + q->count) % serverQueue::queueSize] = sock;
+			q->count += 1;
+		}
 
-							std::cout << "ITC Print: ";
+		q->notEmpty.notify_one();
+	}
 
-							if ((startTime != 0) || (endTime != 0)) {
-								std::cout << "Msg Tics: <" << startTime << "-" << endTime << "> ";
-							}
+	return 0;
+}
 
-							std::cout << s;
+int main(int argc, char *argv[])
+{
+	char *bf_name = nullptr;
+	int numThreads = 0;
+	int port = 0;
+	int numArgs = 0;
 
-							firstPrint = false;
+	// pull out the batch, server, and elf loader options. The rest are decode options
 
-							s = trace->getITCPrintStr(core,haveStr,startTime,endTime);
-						}
-					}
+	char **args = new char *[argc+1];
 
-					core_mask >>= 1;
-				}
+	for (int i = 0; i < argc; i++) {
+		if (strcmp("-batch",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				printf("Error: option -batch requires a file name\n");
+				usage(stdout,argv[0]);
+				delete [] args;
+				return 1;
 			}
-//		}
-	} while (ec == TraceDqr::DQERR_OK);
 
-	if (ec == TraceDqr::DQERR_EOF) {
-		if (firstPrint == false) {
-			printf("\n");
+			bf_name = argv[i];
 		}
-		printf("End of Trace File\n");
-	}
-	else {
-		printf("Error (%d) terminated trace decode\n",ec);
-		return 1;
-	}
-
-	if ((trace != nullptr) && (itcPrintOpts != TraceDqr::ITC_OPT_NONE)) {
-		std::string s = "";
-		bool haveStr;
+		else if (strcmp("-server",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				printf("Error: option -server requires a port number\n");
+				usage(stdout,argv[0]);
+				delete [] args;
+				return 1;
+			}
 
-		core_mask = trace->getITCFlushMask();
+			port = atoi(argv[i]);
+			if ((port <= 0) || (port > 65535)) {
+				printf("Error: option -server requires a port number between 1 and 65535\n");
+				delete [] args;
+				return 1;
+			}
+		}
+		else if (strncmp("-threads=",argv[i],strlen("-threads=")) == 0) {
+			numThreads = atoi(argv[i]+strlen("-threads="));
+		}
+		else if (strcmp("-nativeelf",argv[i]) == 0) {
+			Trace::setNativeElfLoader(true);
+		}
+		else if (strcmp("-nonativeelf",argv[i]) == 0) {
+			Trace::setNativeElfLoader(false);
+		}
+		else if (strcmp("-elfcachedir",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				printf("Error: option -elfcachedir requires a directory name\n");
+				usage(stdout,argv[0]);
+				delete [] args;
+				return 1;
+			}
 
-		for (int core = 0; core_mask != 0; core++) {
-			if (core_mask & 1) {
-				s = trace->flushITCPrintStr(core,haveStr,startTime,endTime);
-				while (haveStr != false) {
-					if (firstPrint == false) {
-						printf("\n");
-					}
+			Trace::setElfCacheDir(argv[i]);
+		}
+		else if (strcmp("-elftimes",argv[i]) == 0) {
+			Trace::setElfLoadTimes(true);
+		}
+		else if (strcmp("-debug",argv[i]) == 0) {
+			globalDebugFlag = 1;
+		}
+		else if (strcmp("-nodebug",argv[i]) == 0) {
+			globalDebugFlag = 0;
+		}
+		else if (strncmp("-predecodelimit=",argv[i],strlen("-predecodelimit=")) == 0) {
+			int limit = atoi(argv[i]+strlen("-predecodelimit="));
 
-					if (srcbits > 0) {
-						printf("[%d] ",core);
-					}
+			if (limit < 0) {
+				printf("Error: option -predecodelimit requires a size in megabytes >= 0\n");
+				usage(stdout,argv[0]);
+				delete [] args;
+				return 1;
+			}
 
-					std::cout << "ITC Print: ";
+			Trace::setPredecodeLimit((uint32_t)limit);
+		}
+		else if (strcmp("-kmemprewarm",argv[i]) == 0) {
+			Trace::setKMemPrewarm(true);
+		}
+		else if (strcmp("-libcache",argv[i]) == 0) {
+			Trace::setLibImageCaching(true);
+		}
+		else if (strcmp("-nolibcache",argv[i]) == 0) {
+			Trace::setLibImageCaching(false);
+		}
+		else if (strcmp("-startuptimes",argv[i]) == 0) {
+			Trace::setStartupTimes(true);
+		}
+		else if (strcmp("-srcindex",argv[i]) == 0) {
+			Trace::setSrcIndexing(true);
+		}
+		else if (strncmp("-srcindex=",argv[i],strlen("-srcindex=")) == 0) {
+			if (argv[i][strlen("-srcindex=")] == 0) {
+				printf("Error: option -srcindex= requires a file name\n");
+				usage(stdout,argv[0]);
+				delete [] args;
+				return 1;
+			}
 
-					if ((startTime != 0) || (endTime != 0)) {
-						std::cout << "Msg Tics: <" << startTime << "-" << endTime << "> ";
-					}
+			Trace::setSrcIndexing(true);
+			Trace::setSrcIndexFile(argv[i]+strlen("-srcindex="));
+		}
+		else if (strcmp("-decodetest",argv[i]) == 0) {
+			TraceDqr::DQErr rc;
 
-					std::cout << s;
+			rc = Trace::decodeSelfTest(1 << 24);
 
-					firstPrint = false;
+			delete [] args;
 
-					s = trace->flushITCPrintStr(core,haveStr,startTime,endTime);
-				}
+			if (rc != TraceDqr::DQERR_OK) {
+				return 1;
 			}
 
-			core_mask >>= 1;
+			return 0;
 		}
-	}
+		else if (strcmp("-odbench",argv[i]) == 0) {
+			i += 1;
+			if (i >= argc) {
+				printf("Error: option -odbench requires a file name\n");
+				usage(stdout,argv[0]);
+				delete [] args;
+				return 1;
+			}
 
-	if (analytics_detail > 0) {
-		if (trace != nullptr) {
-			trace->analyticsToText(dst,sizeof dst,analytics_detail);
-			if (firstPrint == false) {
-				printf("\n");
+			TraceDqr::DQErr rc;
+
+			rc = Trace::objDumpBenchmark(argv[i]);
+
+			delete [] args;
+
+			if (rc != TraceDqr::DQERR_OK) {
+				return 1;
 			}
-			firstPrint = false;
-			printf("%s",dst);
+
+			return 0;
 		}
-		if (sim != nullptr) {
-			sim->analyticsToText(dst,sizeof dst,analytics_detail);
-			if (firstPrint == false) {
-				printf("\n");
-			}
-			firstPrint = false;
-			printf("%s",dst);
+		else {
+			args[numArgs] = argv[i];
+			numArgs += 1;
 		}
 	}
 
-	if (trace != nullptr) {
-		delete trace;
-		trace = nullptr;
+	args[numArgs] = nullptr;
 
-		if (pidMap != nullptr) {
-			delete [] pidMap;
-			pidMap = nullptr;
-		}
-	}
+	int rc;
 
-	if (sim != nullptr) {
-		delete sim;
-		sim = nullptr;
+	if (port != 0) {
+		rc = runServer(port,numThreads,numArgs,args);
 	}
-
-	if (vcd != nullptr) {
-		delete vcd;
-		vcd = nullptr;
+	else if (bf_name != nullptr) {
+		rc = runBatch(bf_name,numThreads,numArgs,args);
+	}
+	else {
+		rc = runDecode(numArgs,args);
 	}
 
-	return 0;
+	delete [] args;
+
+	return rc;
 }
@@ -6,8 +6,10 @@
 #include <fstream>
 #include <cstring>
 #include <cstdint>
+#include <cstdarg>
 #include <time.h>
 #include <sys/stat.h>
+#include <system_error>
 #ifdef WINDOWS
 #include <winsock2.h>
 #else // WINDOWS
@@ -17,7 +19,6 @@
 #include "dqr.hpp"
 #include "trace.hpp"
 
-#ifdef DO_TIMES
 Timer::Timer()
 {
 	struct timespec ts;
@@ -52,7 +53,100 @@ double Timer::etime()
 
 	return t-startTime;
 }
-#endif // DO_TIMES
+
+thread_local FILE *threadMsgFile = nullptr;
+
+int dqrPrintf(const char *format,...)
+{
+	va_list args;
+	int rc;
+
+	va_start(args,format);
+	rc = vfprintf((threadMsgFile != nullptr) ? threadMsgFile : stdout,format,args);
+	va_end(args);
+
+	return rc;
+}
+
+// the worker threads use the message file and display settings of the thread that called runJobs()
+
+struct runJobsState {
+	void           (*doJob)(void *context,int job);
+	void            *context;
+	int              numJobs;
+	std::atomic<int> nextJob;
+	FILE            *msgFile;
+	displaySettings *settings;
+};
+
+static void runJobsWorker(runJobsState *state)
+{
+	threadMsgFile = state->msgFile;
+	threadDisplaySettings = state->settings;
+
+	for (int j = state->nextJob++; j < state->numJobs; j = state->nextJob++) {
+		state->doJob(state->context,j);
+	}
+}
+
+void runJobs(int numJobs,void (*doJob)(void *context,int job),void *context)
+{
+	if (numJobs <= 0) {
+		return;
+	}
+
+	runJobsState state;
+
+	state.doJob = doJob;
+	state.context = context;
+	state.numJobs = numJobs;
+	state.nextJob = 0;
+	state.msgFile = threadMsgFile;
+	state.settings = threadDisplaySettings;
+
+	// hardware_concurrency() is 0 if it is not known
+
+	int numThreads;
+
+	numThreads = std::thread::hardware_concurrency();
+	if (numThreads < 1) {
+		numThreads = 1;
+	}
+
+	if (numThreads > numJobs) {
+		numThreads = numJobs;
+	}
+
+	std::thread *threads = nullptr;
+	int numStarted = 0;
+
+	if (numThreads > 1) {
+		threads = new (std::nothrow) std::thread[numThreads-1];
+		if (threads != nullptr) {
+			// if a thread can't be created, the threads already started (or just this one) do the rest
+
+			try {
+				for (numStarted = 0; numStarted < numThreads-1; numStarted++) {
+					threads[numStarted] = std::thread(runJobsWorker,&state);
+				}
+			}
+			catch (const std::system_error &e) {
+				if (globalDebugFlag) printf("Debug: runJobs(): Could not start worker thread: %s\n",e.what());
+			}
+		}
+	}
+
+	runJobsWorker(&state);
+
+	if (threads != nullptr) {
+		for (int i = 0; i < numStarted; i++) {
+			threads[i].join();
+		}
+
+		delete [] threads;
+		threads = nullptr;
+	}
+}
 
 // class CATrace methods
 
@@ -1496,6 +1590,17 @@ PerfConverter::PerfConverter(char *elf,char *rtd,Disassembler *disassembler,int
 		lastCount[i] = nullptr;
 	}
 
+	for (int i = 0; i < (int)(sizeof perfBuffs / sizeof perfBuffs[0]); i++) {
+		perfBuffs[i].buff = nullptr;
+		perfBuffs[i].len = 0;
+	}
+
+	perfBuff.buff = nullptr;
+	perfBuff.len = 0;
+
+	fileInfoCache = nullptr;
+	elfNamePath = nullptr;
+
 	this->disassembler = disassembler;
 	frequency = freq;
 
@@ -1530,7 +1635,7 @@ PerfConverter::PerfConverter(char *elf,char *rtd,Disassembler *disassembler,int
 
 	sprintf(elfNamePath,"# ELFPATH=%s\n",elf);
 
-	write(perfFD,elfNamePath,strlen(elfNamePath));
+	perfWrite(perfFD,perfBuff,elfNamePath,strlen(elfNamePath));
 
 	strcat(perfNameGen,"perf");
 
@@ -1573,16 +1678,33 @@ PerfConverter::~PerfConverter()
 
 	for (int i = 0; i < (int)(sizeof perfFDs / sizeof perfFDs[0]); i++) {
 		if (perfFDs[i] >= 0) {
+			perfFlush(perfFDs[i],perfBuffs[i]);
 			close(perfFDs[i]);
 			perfFDs[i] = -1;
 		}
+
+		if (perfBuffs[i].buff != nullptr) {
+			delete [] perfBuffs[i].buff;
+			perfBuffs[i].buff = nullptr;
+		}
 	}
 
 	if (perfFD >= 0) {
+		perfFlush(perfFD,perfBuff);
 		close(perfFD);
 		perfFD = -1;
 	}
 
+	if (perfBuff.buff != nullptr) {
+		delete [] perfBuff.buff;
+		perfBuff.buff = nullptr;
+	}
+
+	if (fileInfoCache != nullptr) {
+		delete [] fileInfoCache;
+		fileInfoCache = nullptr;
+	}
+
 	if (elfNamePath != nullptr) {
 		delete [] elfNamePath;
 		elfNamePath = nullptr;
@@ -1596,6 +1718,123 @@ PerfConverter::~PerfConverter()
 	}
 }
 
+void PerfConverter::perfFlush(int fd,perfBuffer &pb)
+{
+	char *p = pb.buff;
+	int len = pb.len;
+
+	while (len > 0) {
+		int n = write(fd,p,len);
+		if (n <= 0) {
+			break;
+		}
+
+		p += n;
+		len -= n;
+	}
+
+	pb.len = 0;
+}
+
+void PerfConverter::perfWrite(int fd,perfBuffer &pb,const char *data,int len)
+{
+	if (pb.buff == nullptr) {
+		pb.buff = new (std::nothrow) char[perfBuffSize];
+		if (pb.buff == nullptr) {
+			// no buffer; write straight through
+
+			write(fd,data,len);
+			return;
+		}
+
+		pb.len = 0;
+	}
+
+	if (pb.len + len > perfBuffSize) {
+		perfFlush(fd,pb);
+
+		if (len > perfBuffSize) {
+			write(fd,data,len);
+			return;
+		}
+	}
+
+	memcpy(&pb.buff[pb.len],data,len);
+	pb.len += len;
+}
+
+TraceDqr::DQErr PerfConverter::getFileInfo(int core,TraceDqr::ADDRESS addr,const char *&text,int &len)
+{
+	if (disassembler == nullptr) {
+		text = "\n";
+		len = sizeof "\n" - 1;
+
+		return TraceDqr::DQERR_OK;
+	}
+
+	if (fileInfoCache == nullptr) {
+		fileInfoCache = new (std::nothrow) fileInfoEntry[fileInfoCacheSize];
+		if (fileInfoCache != nullptr) {
+			for (int i = 0; i < fileInfoCacheSize; i++) {
+				fileInfoCache[i].len = 0;
+			}
+		}
+	}
+
+	fileInfoEntry *ep = nullptr;
+
+	if (fileInfoCache != nullptr) {
+		ep = &fileInfoCache[((addr >> 1) ^ core) & (fileInfoCacheSize - 1)];
+
+		if ((ep->len > 0) && (ep->addr == addr) && (ep->core == core)) {
+			text = ep->text;
+			len = ep->len;
+
+			return TraceDqr::DQERR_OK;
+		}
+	}
+
+	TraceDqr::DQErr rc;
+	const char *filename;
+	int   cutPathIndex;
+	const char *functionname;
+	unsigned int   linenumber;
+	const char *line;
+
+	rc = disassembler->getSrcLines(addr,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
+	if (rc != TraceDqr::DQERR_OK) {
+		return TraceDqr::DQERR_ERR;
+	}
+
+	if (functionname == nullptr) {
+		int offset;
+
+		rc = disassembler->getFunctionName(addr,functionname,offset,core);
+		if (rc != TraceDqr::DQERR_OK) {
+			return TraceDqr::DQERR_ERR;
+		}
+	}
+
+	len = snprintf(fileInfoBuff,sizeof fileInfoBuff," ffl:%s:%s:%d\n",filename?filename:"",functionname?functionname:"",linenumber);
+	if (len >= (int)sizeof fileInfoBuff) {
+		len = sizeof fileInfoBuff - 1;
+	}
+
+	if ((ep != nullptr) && (len < fileInfoMaxLen)) {
+		memcpy(ep->text,fileInfoBuff,len+1);
+		ep->addr = addr;
+		ep->core = core;
+		ep->len = len;
+
+		text = ep->text;
+	}
+	else {
+		text = fileInfoBuff;
+	}
+
+	return TraceDqr::DQERR_OK;
+}
+
 TraceDqr::DQErr PerfConverter::emitPerfAddr(int core,TraceDqr::TIMESTAMP ts,TraceDqr::ADDRESS pc)
 {
 	char msgBuff[512];
@@ -1617,7 +1856,7 @@ TraceDqr::DQErr PerfConverter::emitPerfAddr(int core,TraceDqr::TIMESTAMP ts,Trac
 			return TraceDqr::DQERR_OK;
 		}
 
-		write(perfFDs[pt_addressIndex],elfNamePath,strlen(elfNamePath));
+		perfWrite(perfFDs[pt_addressIndex],perfBuffs[pt_addressIndex],elfNamePath,strlen(elfNamePath));
 
 		switch (cntType[core]) {
 		case perfCount_Raw:
@@ -1634,51 +1873,30 @@ TraceDqr::DQErr PerfConverter::emitPerfAddr(int core,TraceDqr::TIMESTAMP ts,Trac
 			break;
 		}
 
-		write(perfFDs[pt_addressIndex],msgBuff,n);
+		perfWrite(perfFDs[pt_addressIndex],perfBuffs[pt_addressIndex],msgBuff,n);
 	}
 
 	if ((perfFDs[pt_addressIndex] >= 0) || (perfFD >= 0)) {
-		char fileInfoBuff[512];
+		TraceDqr::DQErr rc;
+		const char *fileInfo;
 		int f;
 
-		strcpy(fileInfoBuff,"\n");
-		f = sizeof "\n" - 1;
-
-		if (disassembler != nullptr) {
-			TraceDqr::DQErr rc;
-			const char *filename;
-			int   cutPathIndex;
-			const char *functionname;
-			unsigned int   linenumber;
-			const char *line;
-
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
-			if (rc != TraceDqr::DQERR_OK) {
-				return TraceDqr::DQERR_ERR;
-			}
-
-			if (functionname == nullptr) {
-				int offset;
-
-				rc = disassembler->getFunctionName(pc,functionname,offset);
-				if (rc != TraceDqr::DQERR_OK) {
-					return TraceDqr::DQERR_ERR;
-				}
-			}
-
-			f = snprintf(fileInfoBuff,sizeof fileInfoBuff," ffl:%s:%s:%d\n",filename?filename:"",functionname?functionname:"",linenumber);
+		rc = getFileInfo(core,pc,fileInfo,f);
+		if (rc != TraceDqr::DQERR_OK) {
+			return rc;
 		}
 
+
 		n = snprintf(msgBuff,sizeof msgBuff,"[%d] %d PC=0x%08llx [Address]",core,ts,pc);
 
 		if (perfFD >= 0) {
-			write(perfFD,msgBuff,n);
-			write(perfFD,fileInfoBuff,f);
+			perfWrite(perfFD,perfBuff,msgBuff,n);
+			perfWrite(perfFD,perfBuff,fileInfo,f);
 		}
 
 		if (perfFDs[pt_addressIndex] >= 0) {
-			write(perfFDs[pt_addressIndex],msgBuff,n);
-			write(perfFDs[pt_addressIndex],fileInfoBuff,f);
+			perfWrite(perfFDs[pt_addressIndex],perfBuffs[pt_addressIndex],msgBuff,n);
+			perfWrite(perfFDs[pt_addressIndex],perfBuffs[pt_addressIndex],fileInfo,f);
 		}
 	}
 
@@ -1706,7 +1924,7 @@ TraceDqr::DQErr PerfConverter::emitPerfFnEntry(int core,TraceDqr::TIMESTAMP ts,T
 			return TraceDqr::DQERR_OK;
 		}
 
-		write(perfFDs[pt_fnIndex],elfNamePath,strlen(elfNamePath));
+		perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],elfNamePath,strlen(elfNamePath));
 
 		switch (cntType[core]) {
 		case perfCount_Raw:
@@ -1723,51 +1941,30 @@ TraceDqr::DQErr PerfConverter::emitPerfFnEntry(int core,TraceDqr::TIMESTAMP ts,T
 			break;
 		}
 
-		write(perfFDs[pt_fnIndex],msgBuff,n);
+		perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],msgBuff,n);
 	}
 
 	if ((perfFDs[pt_fnIndex] >= 0) || (perfFD >= 0)) {
-		char fileInfoBuff[512];
+		TraceDqr::DQErr rc;
+		const char *fileInfo;
 		int f;
 
-		strcpy(fileInfoBuff,"\n");
-		f = sizeof "\n" - 1;
-
-		if (disassembler != nullptr) {
-			TraceDqr::DQErr rc;
-			const char *filename;
-			int   cutPathIndex;
-			const char *functionname;
-			unsigned int   linenumber;
-			const char *line;
-
-			rc = disassembler->getSrcLines(fnAddr,&filename,&cutPathIndex,&functionname,&linenumber,&line);
-			if (rc != TraceDqr::DQERR_OK) {
-				return TraceDqr::DQERR_ERR;
-			}
-
-			if (functionname == nullptr) {
-				int offset;
-
-				rc = disassembler->getFunctionName(fnAddr,functionname,offset);
-				if (rc != TraceDqr::DQERR_OK) {
-					return TraceDqr::DQERR_ERR;
-				}
-			}
-
-			f = snprintf(fileInfoBuff,sizeof fileInfoBuff," ffl:%s:%s:%d\n",filename?filename:"",functionname?functionname:"",linenumber);
+		rc = getFileInfo(core,fnAddr,fileInfo,f);
+		if (rc != TraceDqr::DQERR_OK) {
+			return rc;
 		}
 
+
 		n = snprintf(msgBuff,sizeof msgBuff,"[%d] %d [Func Enter at 0x%08llx] [Called From 0x%08llx]",core,ts,fnAddr,csAddr);
 
 		if (perfFD >= 0) {
-			write(perfFD,msgBuff,n);
-			write(perfFD,fileInfoBuff,f);
+			perfWrite(perfFD,perfBuff,msgBuff,n);
+			perfWrite(perfFD,perfBuff,fileInfo,f);
 		}
 
 		if (perfFDs[pt_fnIndex] >= 0) {
-			write(perfFDs[pt_fnIndex],msgBuff,n);
-			write(perfFDs[pt_fnIndex],fileInfoBuff,f);
+			perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],msgBuff,n);
+			perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],fileInfo,f);
 		}
 	}
 
@@ -1795,7 +1992,7 @@ TraceDqr::DQErr PerfConverter::emitPerfFnExit(int core,TraceDqr::TIMESTAMP ts,Tr
 			return TraceDqr::DQERR_OK;
 		}
 
-		write(perfFDs[pt_fnIndex],elfNamePath,strlen(elfNamePath));
+		perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],elfNamePath,strlen(elfNamePath));
 
 		switch (cntType[core]) {
 		case perfCount_Raw:
@@ -1812,51 +2009,29 @@ TraceDqr::DQErr PerfConverter::emitPerfFnExit(int core,TraceDqr::TIMESTAMP ts,Tr
 			break;
 		}
 
-		write(perfFDs[pt_fnIndex],msgBuff,n);
+		perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],msgBuff,n);
 	}
 
 	if ((perfFDs[pt_fnIndex] >= 0) || (perfFD >= 0)) {
-		char fileInfoBuff[512];
+		TraceDqr::DQErr rc;
+		const char *fileInfo;
 		int f;
 
-		strcpy(fileInfoBuff,"\n");
-		f = sizeof "\n" - 1;
-
-		if (disassembler != nullptr) {
-			TraceDqr::DQErr rc;
-			const char *filename;
-			int   cutPathIndex;
-			const char *functionname;
-			unsigned int   linenumber;
-			const char *line;
-
-			rc = disassembler->getSrcLines(csAddr,&filename,&cutPathIndex,&functionname,&linenumber,&line);
-			if (rc != TraceDqr::DQERR_OK) {
-				return TraceDqr::DQERR_ERR;
-			}
-
-			if (functionname == nullptr) {
-				int offset;
-
-				rc = disassembler->getFunctionName(csAddr,functionname,offset);
-				if (rc != TraceDqr::DQERR_OK) {
-					return TraceDqr::DQERR_ERR;
-				}
-			}
-
-			f = snprintf(fileInfoBuff,sizeof fileInfoBuff," ffl:%s:%s:%d\n",filename?filename:"",functionname?functionname:"",linenumber);
-
+		rc = getFileInfo(core,csAddr,fileInfo,f);
+		if (rc != TraceDqr::DQERR_OK) {
+			return rc;
 		}
+
 		n = snprintf(msgBuff,sizeof msgBuff,"[%d] %d [Func Exit] [Func at 0x%08llx] [Returning to 0x%08llx]",core,ts,fnAddr,csAddr);
 
 		if (perfFD >= 0) {
-			write(perfFD,msgBuff,n);
-			write(perfFD,fileInfoBuff,f);
+			perfWrite(perfFD,perfBuff,msgBuff,n);
+			perfWrite(perfFD,perfBuff,fileInfo,f);
 		}
 
 		if (perfFDs[pt_fnIndex] >= 0) {
-			write(perfFDs[pt_fnIndex],msgBuff,n);
-			write(perfFDs[pt_fnIndex],fileInfoBuff,f);
+			perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],msgBuff,n);
+			perfWrite(perfFDs[pt_fnIndex],perfBuffs[pt_fnIndex],fileInfo,f);
 		}
 	}
 
@@ -1884,7 +2059,7 @@ TraceDqr::DQErr PerfConverter::emitPerfCntType(int core,TraceDqr::TIMESTAMP ts,i
 			break;
 		}
 
-		write(perfFD,msgBuff,n);
+		perfWrite(perfFD,perfBuff,msgBuff,n);
 	}
 
 	return TraceDqr::DQERR_OK;
@@ -1913,7 +2088,7 @@ TraceDqr::DQErr PerfConverter::emitPerfCntr(int core,TraceDqr::TIMESTAMP ts,Trac
 			return TraceDqr::DQERR_OK;
 		}
 
-		write(perfFDs[cntrIndex],elfNamePath,strlen(elfNamePath));
+		perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],elfNamePath,strlen(elfNamePath));
 
 		switch (cntType[core]) {
 		case perfCount_Raw:
@@ -1930,51 +2105,30 @@ TraceDqr::DQErr PerfConverter::emitPerfCntr(int core,TraceDqr::TIMESTAMP ts,Trac
 			break;
 		}
 
-		write(perfFDs[cntrIndex],msgBuff,n);
+		perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],msgBuff,n);
 	}
 
 	if ((perfFDs[cntrIndex] >= 0) || (perfFD >= 0)) {
-		char fileInfoBuff[512];
+		TraceDqr::DQErr rc;
+		const char *fileInfo;
 		int f;
 
-		strcpy(fileInfoBuff,"\n");
-		f = sizeof "\n" - 1;
-
-		if (disassembler != nullptr) {
-			TraceDqr::DQErr rc;
-			const char *filename;
-			int   cutPathIndex;
-			const char *functionname;
-			unsigned int   linenumber;
-			const char *line;
-
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
-			if (rc != TraceDqr::DQERR_OK) {
-				return TraceDqr::DQERR_ERR;
-			}
-
-			if (functionname == nullptr) {
-				int offset;
-
-				rc = disassembler->getFunctionName(pc,functionname,offset);
-				if (rc != TraceDqr::DQERR_OK) {
-					return TraceDqr::DQERR_ERR;
-				}
-			}
-
-			f = snprintf(fileInfoBuff,sizeof fileInfoBuff," ffl:%s:%s:%d\n",filename?filename:"",functionname?functionname:"",linenumber);
+		rc = getFileInfo(core,pc,fileInfo,f);
+		if (rc != TraceDqr::DQERR_OK) {
+			return rc;
 		}
 
+
 		n = snprintf(msgBuff,sizeof msgBuff,"[%d] %d PC=0x%08llx [Perf Cntr] [Index=%d] [Value=%lld] ",core,ts,pc,cntrIndex,cntrVal);
 
 		if (perfFD >= 0) {
-			write(perfFD,msgBuff,n);
-			write(perfFD,fileInfoBuff,f);
+			perfWrite(perfFD,perfBuff,msgBuff,n);
+			perfWrite(perfFD,perfBuff,fileInfo,f);
 		}
 
 		if (perfFDs[cntrIndex] >= 0) {
-			write(perfFDs[cntrIndex],msgBuff,n);
-			write(perfFDs[cntrIndex],fileInfoBuff,f);
+			perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],msgBuff,n);
+			perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],fileInfo,f);
 		}
 	}
 
@@ -1991,7 +2145,7 @@ TraceDqr::DQErr PerfConverter::emitPerfCntrMask(int core,TraceDqr::TIMESTAMP ts,
 
 		n = snprintf(msgBuff,sizeof msgBuff,"[%d] %d [Perf Cntr Mask] [Mask=0x%08x]\n",core,ts,cntrMask);
 
-		write(perfFD,msgBuff,n);
+		perfWrite(perfFD,perfBuff,msgBuff,n);
 	}
 
 	return TraceDqr::DQERR_OK;
@@ -2023,7 +2177,7 @@ TraceDqr::DQErr PerfConverter::emitPerfCntrDef(int core,TraceDqr::TIMESTAMP ts,i
 			return TraceDqr::DQERR_OK;
 		}
 
-		write(perfFDs[cntrIndex],elfNamePath,strlen(elfNamePath));
+		perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],elfNamePath,strlen(elfNamePath));
 
 		switch (cntType[core]) {
 		case perfCount_Raw:
@@ -2040,7 +2194,7 @@ TraceDqr::DQErr PerfConverter::emitPerfCntrDef(int core,TraceDqr::TIMESTAMP ts,i
 			break;
 		}
 
-		write(perfFDs[cntrIndex],msgBuff,n);
+		perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],msgBuff,n);
 	}
 
 	if ((perfFDs[cntrIndex] >= 0) || (perfFD >= 0)) {
@@ -2050,11 +2204,11 @@ TraceDqr::DQErr PerfConverter::emitPerfCntrDef(int core,TraceDqr::TIMESTAMP ts,i
 		n = snprintf(msgBuff,sizeof msgBuff,"[%d] %d [Perf Cntr Def] [Counter=%d] [Type=%d] [Code=%d] [EventData=0x%08lx] [CntrCSR=0x%03x] [CntrBits=%d]\n",core,ts,cntrIndex,cntrType,cntrCode,eventData,csr,bits);
 
 		if (perfFD >= 0) {
-			write(perfFD,msgBuff,n);
+			perfWrite(perfFD,perfBuff,msgBuff,n);
 		}
 
 		if (perfFDs[cntrIndex] >= 0) {
-			write(perfFDs[cntrIndex],msgBuff,n);
+			perfWrite(perfFDs[cntrIndex],perfBuffs[cntrIndex],msgBuff,n);
 		}
 	}
 
@@ -2684,13 +2838,13 @@ TraceDqr::DQErr EventConverter::emitExtTrigEvent(int core,TraceDqr::TIMESTAMP ts
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -2768,13 +2922,13 @@ TraceDqr::DQErr EventConverter::emitWatchpoint(int core,TraceDqr::TIMESTAMP ts,i
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -2912,13 +3066,13 @@ TraceDqr::DQErr EventConverter::emitCallRet(int core,TraceDqr::TIMESTAMP ts,int
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -3008,13 +3162,13 @@ TraceDqr::DQErr EventConverter::emitException(int core,TraceDqr::TIMESTAMP ts,in
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -3087,13 +3241,13 @@ TraceDqr::DQErr EventConverter::emitInterrupt(int core,TraceDqr::TIMESTAMP ts,in
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -3193,12 +3347,12 @@ TraceDqr::DQErr EventConverter::emitContext(int core,TraceDqr::TIMESTAMP ts,int
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 				if (functionname == nullptr) {
 					int offset;
 
-					disassembler->getFunctionName(pc,functionname,offset);
+					disassembler->getFunctionName(pc,functionname,offset,core);
 				}
 
 				f = snprintf(fileInfoBuff,sizeof fileInfoBuff," ffl:%s:%s:%d\n",filename?filename:"",functionname?functionname:"",linenumber);
@@ -3268,13 +3422,13 @@ TraceDqr::DQErr EventConverter::emitPeriodic(int core,TraceDqr::TIMESTAMP ts,int
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -3367,13 +3521,13 @@ TraceDqr::DQErr EventConverter::emitControl(int core,TraceDqr::TIMESTAMP ts,int
 			unsigned int   linenumber;
 			const char *line;
 
-			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line);
+			rc = disassembler->getSrcLines(pc,&filename,&cutPathIndex,&functionname,&linenumber,&line,core);
 			if (rc == TraceDqr::DQERR_OK) {
 
 				if (functionname == nullptr) {
 					int offset;
 
-					rc = disassembler->getFunctionName(pc,functionname,offset);
+					rc = disassembler->getFunctionName(pc,functionname,offset,core);
 					if (rc != TraceDqr::DQERR_OK) {
 						return TraceDqr::DQERR_ERR;
 					}
@@ -4119,8 +4273,11 @@ TraceSettings::TraceSettings()
 	kmemPath = nullptr;
 	tType = TraceDqr::TRACETYPE_unknown;
 	tolerateErrors = false;
+	predecodeLimit = defaultPredecodeLimit;
 }
 
+uint32_t TraceSettings::defaultPredecodeLimit = 256;
+
 TraceSettings::~TraceSettings()
 {
 	if (tfName != nullptr) {
@@ -4409,6 +4566,13 @@ TraceDqr::DQErr TraceSettings::addSettings(propertiesParser *properties)
 					return rc;
 				}
 			}
+			else if (strcasecmp("predecodelimit",name) == 0) {
+				rc = propertyToPredecodeLimit(value);
+				if (rc != TraceDqr::DQERR_OK) {
+					printf("Error: TraceSettings::addSettings(): Could not set predecodeLimit in settings\n");
+					return rc;
+				}
+			}
 		}
 	} while (rc == TraceDqr::DQERR_OK);
 
@@ -4675,6 +4839,21 @@ TraceDqr::DQErr TraceSettings::propertyToSrcBits(const char *value)
 	return TraceDqr::DQERR_OK;
 }
 
+TraceDqr::DQErr TraceSettings::propertyToPredecodeLimit(const char *value)
+{
+	if ((value != nullptr) && (value[0] != '\0')) {
+		char *endp;
+
+		predecodeLimit = strtoul(value,&endp,0);
+
+		if (endp == value) {
+			return TraceDqr::DQERR_ERR;
+		}
+	}
+
+	return TraceDqr::DQERR_OK;
+}
+
 TraceDqr::DQErr TraceSettings::propertyToNumAddrBits(const char *value)
 {
 	if ((value != nullptr) && (value[0] != '\0')) {
@@ -5355,11 +5534,20 @@ pidMap::~pidMap()
   }
 }
 
+// elf files shared by all Trace and ObjFile objects when elf caching is enabled (see Trace::setElfCaching())
+
+// libImageCache comes first so it is destroyed after elfCache, which releases the images of its ElfReaders
+
+LibImageCache libImageCache;
+ElfCache elfCache;
+
 process::process()
 {
   pid = -1;
   elfName = nullptr;
+  mapFileName = nullptr;
   elfReader = nullptr;
+  sharedElfReader = false;
   disassembler = nullptr;
   eventConverter = nullptr;
   ctf = nullptr;
@@ -5373,8 +5561,18 @@ process::~process()
     elfName = nullptr;
   }
 
+  if (mapFileName != nullptr) {
+    delete [] mapFileName;
+    mapFileName = nullptr;
+  }
+
   if (elfReader != nullptr) {
-    delete elfReader;
+    if (sharedElfReader) {
+      elfCache.releaseElfReader(elfReader);
+    }
+    else {
+      delete elfReader;
+    }
     elfReader = nullptr;
   }
 
@@ -5399,20 +5597,739 @@ process::~process()
   }
 }
 
-// class trace methods
+// class ElfCache methods
 
-Trace::Trace(char *pf_name)
+ElfCache::ElfCache()
 {
-	status = TraceDqr::DQERR_OK;
+	enabled = false;
+	entries = nullptr;
+}
 
-	sfp          = nullptr;
-        numProcesses = 0;
-	processes    = nullptr;
-	numPids      = 0;
-        pidList      = nullptr;
-	kMem         = nullptr;
-	caTrace      = nullptr;
-	counts       = nullptr;//delete this line if compile error
+ElfCache::~ElfCache()
+{
+	while (entries != nullptr) {
+		elfCacheEntry *next = entries->next;
+
+		if (entries->elfReader != nullptr) {
+			delete entries->elfReader;
+			entries->elfReader = nullptr;
+		}
+
+		delete [] entries->elfName;
+		delete [] entries->odName;
+		delete entries;
+
+		entries = next;
+	}
+}
+
+// setEnable() should be called before any Trace objects that use the cache are created. Disabling
+// the cache deletes the ElfReader objects that are not in use. The rest are deleted when released
+
+void ElfCache::setEnable(bool enable)
+{
+	std::lock_guard<std::mutex> guard(cacheLock);
+
+	enabled = enable;
+
+	if (enable == false) {
+		flush();
+	}
+}
+
+void ElfCache::flush()
+{
+	elfCacheEntry **epp = &entries;
+
+	while (*epp != nullptr) {
+		elfCacheEntry *ep = *epp;
+
+		if (ep->ready && (ep->refCount == 0)) {
+			*epp = ep->next;
+
+			if (ep->elfReader != nullptr) {
+				delete ep->elfReader;
+				ep->elfReader = nullptr;
+			}
+
+			delete [] ep->elfName;
+			delete [] ep->odName;
+			delete ep;
+		}
+		else {
+			epp = &ep->next;
+		}
+	}
+}
+
+ElfReader *ElfCache::getElfReader(const char *elfName,const char *odExe,uint64_t predecodeLimit)
+{
+	struct stat sb;
+
+	if (stat(elfName,&sb) != 0) {
+		printf("Error: ElfCache::getElfReader(): Could not stat %s\n",elfName);
+		return nullptr;
+	}
+
+	bool nativeLoader = ElfReader::getNativeLoader();
+
+	std::unique_lock<std::mutex> lk(cacheLock);
+
+	elfCacheEntry *ep;
+	bool waited = false;
+
+	for (;;) {
+		elfCacheEntry **epp = &entries;
+
+		while (*epp != nullptr) {
+			ep = *epp;
+
+			if ((strcmp(ep->elfName,elfName) == 0) && (strcmp(ep->odName,odExe) == 0)) {
+				if ((ep->size == (int64_t)sb.st_size) && (ep->mtime == (int64_t)sb.st_mtime)) {
+					if ((ep->predecodeLimit == predecodeLimit) && (ep->nativeLoader == nativeLoader)) {
+						break;
+					}
+				}
+				else if (ep->ready && (ep->refCount == 0)) {
+					// the elf file has been rebuilt since this entry was read and nobody is using it
+
+					*epp = ep->next;
+
+					if (ep->elfReader != nullptr) {
+						delete ep->elfReader;
+						ep->elfReader = nullptr;
+					}
+
+					delete [] ep->elfName;
+					delete [] ep->odName;
+					delete ep;
+
+					continue;
+				}
+			}
+
+			epp = &ep->next;
+		}
+
+		ep = *epp;
+
+		if (ep == nullptr) {
+			// a failed read removes its entry, so if the read waited for is gone it failed
+
+			if (waited) {
+				return nullptr;
+			}
+
+			break;
+		}
+
+		if (ep->ready) {
+			// most recently used entries are first, so trim() removes the ones not used for the longest time
+
+			*epp = ep->next;
+			ep->next = entries;
+			entries = ep;
+
+			ep->refCount += 1;
+
+			return ep->elfReader;
+		}
+
+		// another thread is still reading the elf file. The entry is gone after the wait if the read failed
+
+		readyCond.wait(lk);
+
+		waited = true;
+	}
+
+	ep = new elfCacheEntry;
+
+	ep->elfName = new char [strlen(elfName)+1];
+	strcpy(ep->elfName,elfName);
+	ep->odName = new char [strlen(odExe)+1];
+	strcpy(ep->odName,odExe);
+	ep->predecodeLimit = predecodeLimit;
+	ep->nativeLoader = nativeLoader;
+	ep->size = (int64_t)sb.st_size;
+	ep->mtime = (int64_t)sb.st_mtime;
+	ep->ready = false;
+	ep->refCount = 1;
+	ep->elfReader = nullptr;
+
+	ep->next = entries;
+	entries = ep;
+
+	// don't hold the lock while objdump runs so other elf files can be read at the same time
+
+	lk.unlock();
+
+	ElfReader *elfReader;
+
+	elfReader = new (std::nothrow) ElfReader(elfName,odExe,0);
+	if (elfReader != nullptr) {
+		if ((elfReader->getStatus() != TraceDqr::DQERR_OK) || (elfReader->seal(predecodeLimit) != TraceDqr::DQERR_OK)) {
+			printf("Error: ElfCache::getElfReader(): Could not create ElfReader object for %s\n",elfName);
+
+			delete elfReader;
+			elfReader = nullptr;
+		}
+	}
+
+	lk.lock();
+
+	if (elfReader == nullptr) {
+		// don't keep the failure (objdump missing, elf file still being written), so the elf file is read
+		// again the next time it is asked for
+
+		elfCacheEntry **epp = &entries;
+
+		while (*epp != ep) {
+			epp = &(*epp)->next;
+		}
+
+		*epp = ep->next;
+
+		delete [] ep->elfName;
+		delete [] ep->odName;
+		delete ep;
+	}
+	else {
+		ep->elfReader = elfReader;
+		ep->ready = true;
+
+		trim();
+	}
+
+	readyCond.notify_all();
+
+	return elfReader;
+}
+
+void ElfCache::releaseElfReader(ElfReader *elfReader)
+{
+	std::lock_guard<std::mutex> guard(cacheLock);
+
+	for (elfCacheEntry *ep = entries; ep != nullptr; ep = ep->next) {
+		if (ep->elfReader == elfReader) {
+			ep->refCount -= 1;
+			break;
+		}
+	}
+
+	if (enabled == false) {
+		flush();
+	}
+	else {
+		trim();
+	}
+}
+
+// trim(): keep at most maxUnused elf files that no Trace object is using, so a long running dqr -batch or
+// -server does not keep every elf file it has seen. The ones used longest ago (last in the list) go first.
+// Called with cacheLock held
+
+void ElfCache::trim()
+{
+	int numUnused = 0;
+	elfCacheEntry **epp = &entries;
+
+	while (*epp != nullptr) {
+		elfCacheEntry *ep = *epp;
+
+		if (ep->ready && (ep->refCount == 0)) {
+			numUnused += 1;
+
+			if (numUnused > maxUnused) {
+				*epp = ep->next;
+
+				if (ep->elfReader != nullptr) {
+					delete ep->elfReader;
+					ep->elfReader = nullptr;
+				}
+
+				delete [] ep->elfName;
+				delete [] ep->odName;
+				delete ep;
+
+				continue;
+			}
+		}
+
+		epp = &ep->next;
+	}
+}
+
+// class LibImageCache methods
+
+LibImageCache::LibImageCache()
+{
+	enabled = true;
+	entries = nullptr;
+}
+
+LibImageCache::~LibImageCache()
+{
+	while (entries != nullptr) {
+		libImageEntry *next = entries->next;
+
+		if (entries->image != nullptr) {
+			delete entries->image;
+			entries->image = nullptr;
+		}
+
+		delete [] entries->elfName;
+		delete [] entries->odName;
+		delete entries;
+
+		entries = next;
+	}
+}
+
+// setEnable() only affects shared libraries loaded after the call. Disabling the cache deletes the
+// images that are not in use. The rest are deleted when released
+
+void LibImageCache::setEnable(bool enable)
+{
+	std::lock_guard<std::mutex> guard(cacheLock);
+
+	enabled = enable;
+
+	if (enable == false) {
+		flush();
+	}
+}
+
+void LibImageCache::flush()
+{
+	libImageEntry **epp = &entries;
+
+	while (*epp != nullptr) {
+		libImageEntry *ep = *epp;
+
+		if (ep->ready && (ep->refCount == 0)) {
+			*epp = ep->next;
+
+			if (ep->image != nullptr) {
+				delete ep->image;
+				ep->image = nullptr;
+			}
+
+			delete [] ep->elfName;
+			delete [] ep->odName;
+			delete ep;
+		}
+		else {
+			epp = &ep->next;
+		}
+	}
+}
+
+LibImage *LibImageCache::getImage(const char *elfName,const char *odExe)
+{
+	struct stat sb;
+
+	if (stat(elfName,&sb) != 0) {
+		printf("Error: LibImageCache::getImage(): Could not stat %s\n",elfName);
+		return nullptr;
+	}
+
+	bool nativeLoader = ElfReader::getNativeLoader();
+
+	std::unique_lock<std::mutex> lk(cacheLock);
+
+	libImageEntry *ep;
+	bool waited = false;
+
+	for (;;) {
+		libImageEntry **epp = &entries;
+
+		while (*epp != nullptr) {
+			ep = *epp;
+
+			if ((strcmp(ep->elfName,elfName) == 0) && (strcmp(ep->odName,odExe) == 0)) {
+				if ((ep->size == (int64_t)sb.st_size) && (ep->mtime == (int64_t)sb.st_mtime)) {
+					if (ep->nativeLoader == nativeLoader) {
+						break;
+					}
+				}
+				else if (ep->ready && (ep->refCount == 0)) {
+					// the library has been rebuilt since this entry was read and nobody is using it
+
+					*epp = ep->next;
+
+					if (ep->image != nullptr) {
+						delete ep->image;
+						ep->image = nullptr;
+					}
+
+					delete [] ep->elfName;
+					delete [] ep->odName;
+					delete ep;
+
+					continue;
+				}
+			}
+
+			epp = &ep->next;
+		}
+
+		ep = *epp;
+
+		if (ep == nullptr) {
+			// a failed load removes its entry, so if the load waited for is gone it failed
+
+			if (waited) {
+				return nullptr;
+			}
+
+			break;
+		}
+
+		if (ep->ready) {
+			ep->refCount += 1;
+
+			return ep->image;
+		}
+
+		// another thread is still reading the library. The entry is gone after the wait if the read failed
+
+		readyCond.wait(lk);
+
+		waited = true;
+	}
+
+	ep = new libImageEntry;
+
+	ep->elfName = new char [strlen(elfName)+1];
+	strcpy(ep->elfName,elfName);
+	ep->odName = new char [strlen(odExe)+1];
+	strcpy(ep->odName,odExe);
+	ep->nativeLoader = nativeLoader;
+	ep->size = (int64_t)sb.st_size;
+	ep->mtime = (int64_t)sb.st_mtime;
+	ep->ready = false;
+	ep->refCount = 1;
+	ep->image = nullptr;
+
+	ep->next = entries;
+	entries = ep;
+
+	// don't hold the lock while the library is read so other libraries can be read at the same time
+
+	lk.unlock();
+
+	LibImage *image;
+
+	image = new (std::nothrow) LibImage(elfName,odExe);
+	if ((image != nullptr) && (image->getStatus() != TraceDqr::DQERR_OK)) {
+		printf("Error: LibImageCache::getImage(): Could not load %s\n",elfName);
+
+		delete image;
+		image = nullptr;
+	}
+
+	lk.lock();
+
+	if (image == nullptr) {
+		// don't keep the failure, so the library is read again the next time it is asked for
+
+		libImageEntry **epp = &entries;
+
+		while (*epp != ep) {
+			epp = &(*epp)->next;
+		}
+
+		*epp = ep->next;
+
+		delete [] ep->elfName;
+		delete [] ep->odName;
+		delete ep;
+	}
+	else {
+		ep->image = image;
+		ep->ready = true;
+	}
+
+	readyCond.notify_all();
+
+	return image;
+}
+
+void LibImageCache::releaseImage(LibImage *image)
+{
+	std::lock_guard<std::mutex> guard(cacheLock);
+
+	for (libImageEntry *ep = entries; ep != nullptr; ep = ep->next) {
+		if (ep->image == image) {
+			ep->refCount -= 1;
+			break;
+		}
+	}
+
+	if (enabled == false) {
+		flush();
+	}
+}
+
+// class ProcessLoader methods
+
+ProcessLoader::ProcessLoader(Trace *trace,const char *tfName,int srcBits)
+{
+	status = TraceDqr::DQERR_OK;
+	this->trace = trace;
+	numProcesses = trace->numProcesses;
+	stopPrescan = false;
+	numPending = 0;
+
+	state = new (std::nothrow) int[numProcesses];
+	built = new (std::nothrow) process[numProcesses];
+
+	if ((state == nullptr) || (built == nullptr)) {
+		printf("Error: ProcessLoader::ProcessLoader(): Could not allocate process arrays\n");
+		status = TraceDqr::DQERR_ERR;
+		return;
+	}
+
+	for (int i = 0; i < numProcesses; i++) {
+		state[i] = loadPending;
+	}
+
+	numPending = numProcesses;
+
+	// only trace files are prescanned. A trace read from a socket can't be read twice
+
+	struct stat sb;
+
+	if ((tfName != nullptr) && (stat(tfName,&sb) == 0) && (sb.st_mode & S_IFREG)) {
+		char *name = new char [strlen(tfName)+1];
+		strcpy(name,tfName);
+
+		prescanThread = std::thread(prescan,this,name,srcBits);
+	}
+}
+
+ProcessLoader::~ProcessLoader()
+{
+	// a process the prescan thread is building is finished first
+
+	stopPrescan = true;
+
+	if (prescanThread.joinable()) {
+		prescanThread.join();
+	}
+
+	if (built != nullptr) {
+		delete [] built;
+		built = nullptr;
+	}
+
+	if (state != nullptr) {
+		delete [] state;
+		state = nullptr;
+	}
+}
+
+// build(): build process processIndex, which must be pending. lk must hold loadLock, which is released
+// while the process is built
+
+void ProcessLoader::build(std::unique_lock<std::mutex> &lk,int processIndex)
+{
+	process *pp = &trace->processes[processIndex];
+
+	state[processIndex] = loadBuilding;
+	numPending -= 1;
+
+	lk.unlock();
+
+	TraceDqr::DQErr rc;
+
+	rc = trace->buildProcess(&built[processIndex],pp->pid,pp->mapFileName);
+
+	lk.lock();
+
+	if (rc != TraceDqr::DQERR_OK) {
+		printf("Error: ProcessLoader::build(): Could not build process %d from %s\n",pp->pid,pp->mapFileName);
+		state[processIndex] = loadFailed;
+	}
+	else {
+		state[processIndex] = loadBuilt;
+	}
+
+	loadCond.notify_all();
+}
+
+// install(): move a built process to the Trace object, and give it the path settings of the trace
+
+TraceDqr::DQErr ProcessLoader::install(int processIndex)
+{
+	process *from = &built[processIndex];
+	process *to = &trace->processes[processIndex];
+
+	// the elf name was already set from the mapping file when the trace was configured
+
+	to->elfReader = from->elfReader;
+	to->sharedElfReader = from->sharedElfReader;
+	to->disassembler = from->disassembler;
+
+	from->elfReader = nullptr;
+	from->disassembler = nullptr;
+
+	TraceDqr::DQErr rc;
+
+	rc = to->disassembler->setPathType(trace->pathType);
+	if (rc != TraceDqr::DQERR_OK) {
+		printf("Error: ProcessLoader::install(): setPathType() failed\n");
+		return rc;
+	}
+
+	if ((trace->cutPath != nullptr) || (trace->newRoot != nullptr)) {
+		rc = to->disassembler->subSrcPath(trace->cutPath,trace->newRoot);
+		if (rc != TraceDqr::DQERR_OK) {
+			printf("Error: ProcessLoader::install(): subSrcPath() failed\n");
+			return rc;
+		}
+	}
+
+	return TraceDqr::DQERR_OK;
+}
+
+// getProcess(): make sure process processIndex is built and installed in the Trace object, building it now
+// or waiting for the prescan thread as needed. Only called from the decoding thread
+
+TraceDqr::DQErr ProcessLoader::getProcess(int processIndex)
+{
+	if ((processIndex < 0) || (processIndex >= numProcesses)) {
+		return TraceDqr::DQERR_ERR;
+	}
+
+	std::unique_lock<std::mutex> lk(loadLock);
+
+	for (;;) {
+		switch (state[processIndex]) {
+		case loadInstalled:
+			return TraceDqr::DQERR_OK;
+		case loadFailed:
+			return TraceDqr::DQERR_ERR;
+		case loadPending:
+			build(lk,processIndex);
+			break;
+		case loadBuilding:
+			loadCond.wait(lk);
+			break;
+		case loadBuilt:
+			if (install(processIndex) != TraceDqr::DQERR_OK) {
+				state[processIndex] = loadFailed;
+				return TraceDqr::DQERR_ERR;
+			}
+
+			state[processIndex] = loadInstalled;
+			return TraceDqr::DQERR_OK;
+		default:
+			return TraceDqr::DQERR_ERR;
+		}
+	}
+}
+
+void ProcessLoader::prescanPid(int pid)
+{
+	// the pid list and the pids of the processes are not changed after the trace is configured
+
+	if (trace->numPids > 0) {
+		bool found = false;
+
+		for (int i = 0; (i < trace->numPids) && !found; i++) {
+			found = (trace->pidList[i] == pid);
+		}
+
+		if (!found) {
+			return;
+		}
+	}
+
+	for (int i = 0; i < numProcesses; i++) {
+		if (trace->processes[i].pid == pid) {
+			std::unique_lock<std::mutex> lk(loadLock);
+
+			if (state[i] == loadPending) {
+				build(lk,i);
+			}
+
+			return;
+		}
+	}
+}
+
+// prescan(): read the trace file ahead of the decoder for context changes, and build the process for each
+// pid the first time it shows up. Stops at the end of the trace, at the first error, when every process has
+// been built, or when the loader is deleted
+
+void ProcessLoader::prescan(ProcessLoader *loader,char *tfName,int srcBits)
+{
+	SliceFileParser *sfp;
+
+	sfp = new (std::nothrow) SliceFileParser(tfName,srcBits);
+
+	if ((sfp != nullptr) && (sfp->getErr() == TraceDqr::DQERR_OK)) {
+		Analytics analytics;
+		NexusMessage nm;
+		bool haveMsg;
+
+		while ((loader->stopPrescan == false) && (loader->numPending > 0)) {
+			if (sfp->readNextTraceMsg(nm,analytics,haveMsg) != TraceDqr::DQERR_OK) {
+				break;
+			}
+
+			if (haveMsg == false) {
+				continue;
+			}
+
+			switch (nm.tcode) {
+			case TraceDqr::TCODE_OWNERSHIP_TRACE:
+				if (nm.ownership.tag == 0x2) { // scontext change
+					loader->prescanPid(nm.ownership.pid);
+				}
+				break;
+			case TraceDqr::TCODE_INCIRCUITTRACE:
+				if ((nm.ict.cksrc == TraceDqr::ICT_CONTEXT) && (nm.ict.ckdf == 1) && ((nm.ict.ckdata[1] & 0x3) == 2)) {
+					loader->prescanPid((int)(nm.ict.ckdata[1] >> 2));
+				}
+				break;
+			case TraceDqr::TCODE_INCIRCUITTRACE_WS:
+				if ((nm.ictWS.cksrc == TraceDqr::ICT_CONTEXT) && (nm.ictWS.ckdf == 1) && ((nm.ictWS.ckdata[1] & 0x3) == 2)) {
+					loader->prescanPid((int)(nm.ictWS.ckdata[1] >> 2));
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	if (sfp != nullptr) {
+		delete sfp;
+		sfp = nullptr;
+	}
+
+	delete [] tfName;
+}
+
+// class trace methods
+
+Trace::Trace(char *pf_name)
+{
+	status = TraceDqr::DQERR_OK;
+
+	sfp          = nullptr;
+        numProcesses = 0;
+	processes    = nullptr;
+	numPids      = 0;
+        pidList      = nullptr;
+	kMem         = nullptr;
+	processLoader = nullptr;
+	pidIndex     = nullptr;
+	pidIndexMask = 0;
+	caTrace      = nullptr;
+	counts       = nullptr;//delete this line if compile error
 	vdsoName     = nullptr;
 	mfNameList   = nullptr;
 	rtdName      = nullptr;
@@ -5421,6 +6338,7 @@ Trace::Trace(char *pf_name)
 	itcPrint     = nullptr;
 	nlsStrings   = nullptr;
 	objdump       = nullptr;
+	predecodeLimit = 0;
 	traceType     = TraceDqr::TRACETYPE_BTM;
 	tolerateErrors = true;
 	tolerantError = false;
@@ -5503,6 +6421,9 @@ Trace::Trace(char *tf_name,char *ef_name,int numAddrBits,uint32_t addrDispFlags,
 	numPids      = 0;
 	pidList      = nullptr;
 	kMem         = nullptr;
+	processLoader = nullptr;
+	pidIndex     = nullptr;
+	pidIndexMask = 0;
 	caTrace      = nullptr;
 	counts       = nullptr;//delete this line if compile error
 	vdsoName     = nullptr;
@@ -5513,6 +6434,7 @@ Trace::Trace(char *tf_name,char *ef_name,int numAddrBits,uint32_t addrDispFlags,
 	itcPrint     = nullptr;
 	nlsStrings   = nullptr;
 	objdump       = nullptr;
+	predecodeLimit = 0;
 	traceType     = TraceDqr::TRACETYPE_BTM;
 	tolerateErrors = true;
 	tolerantError = false;
@@ -5545,16 +6467,147 @@ Trace::Trace(char *tf_name,char *ef_name,int numAddrBits,uint32_t addrDispFlags,
 
 	rc = configure(ts);
 
-	if (rc != TraceDqr::DQERR_OK) {
-		cleanUp();
-	}
+	if (rc != TraceDqr::DQERR_OK) {
+		cleanUp();
+	}
+
+	status = rc;
+}
+
+Trace::~Trace()
+{
+	cleanUp();
+}
+
+// setElfCaching(): when enabled, Trace objects for bare metal traces share the ElfReader object for
+// their elf file instead of each running objdump and building their own. Enable before creating the
+// Trace objects, and disable to free the cached elf information
+
+void Trace::setElfCaching(bool enable)
+{
+	elfCache.setEnable(enable);
+}
+
+// setLibImageCaching(): when enabled (the default), the shared libraries of linux traces are read once and
+// shared by every process that maps them, instead of being read again for each process. Disabling frees
+// the libraries not in use
+
+void Trace::setLibImageCaching(bool enable)
+{
+	libImageCache.setEnable(enable);
+}
+
+// setNativeElfLoader(): when enabled (the default), elf files and binary blobs are read directly instead of
+// through objdump, and disassembly text is generated by the decoder. objdump is still used for files that
+// can't be read directly. Set before creating any Trace or ObjFile objects
+
+void Trace::setNativeElfLoader(bool enable)
+{
+	ElfReader::setNativeLoader(enable);
+}
+
+// setElfCacheDir(): keep the loaded state of each elf file in a file in dir, and use it instead of reading
+// the elf file (or running objdump) the next time the same elf file is loaded. nullptr disables the cache
+// (the default). Set before creating any Trace or ObjFile objects
+
+void Trace::setElfCacheDir(const char *dir)
+{
+	ElfDiskCache::setCacheDir(dir);
+}
+
+// setElfLoadTimes(): print how long each elf file (and shared library or blob) takes to load
+
+void Trace::setElfLoadTimes(bool enable)
+{
+	ElfReader::setReportLoadTimes(enable);
+}
+
+// setThreadDisplaySettings(): enable gives the calling thread its own address display settings and target
+// frequency (see displaySettings in trace.hpp), reset to the defaults, instead of sharing the Instruction and
+// NexusMessage statics. Used by threads that each run a decode at the same time as others. Disable goes back
+// to the statics
+
+static thread_local displaySettings threadSettings;
+
+void Trace::setThreadDisplaySettings(bool enable)
+{
+	if (enable) {
+		threadSettings.addrSize = 0;
+		threadSettings.addrDispFlags = 0;
+		threadSettings.addrPrintWidth = 0;
+		threadSettings.targetFrequency = 0;
+
+		threadDisplaySettings = &threadSettings;
+	}
+	else {
+		threadDisplaySettings = nullptr;
+	}
+}
+
+// setThreadMessageFile(): the library messages printed by the calling thread (and the threads it starts to load
+// elf files) go to msgFile instead of stdout. nullptr goes back to stdout
+
+void Trace::setThreadMessageFile(FILE *msgFile)
+{
+	threadMsgFile = msgFile;
+}
+
+// getThreadMessageFile(): where the library messages printed by the calling thread go
+
+FILE *Trace::getThreadMessageFile()
+{
+	if (threadMsgFile != nullptr) {
+		return threadMsgFile;
+	}
+
+	return stdout;
+}
+
+// setPredecodeLimit(): the most memory (in megabytes) the predecode tables of an elf file may use, for
+// traces whose settings don't give predecodeLimit. 0 disables the tables
+
+void Trace::setPredecodeLimit(uint32_t limit)
+{
+	TraceSettings::defaultPredecodeLimit = limit;
+}
+
+// setKMemPrewarm(): for linux traces, read all the page files in the kmem directory (in parallel) when the
+// trace is configured, instead of as the trace reaches them
+
+void Trace::setKMemPrewarm(bool enable)
+{
+	KMem::setPrewarm(enable);
+}
+
+// setSrcIndexing(): index the files under the source root of -cutpath, so source files that are deeper in
+// the tree than their cut path name are found. Off by default
+
+void Trace::setSrcIndexing(bool enable)
+{
+	SrcTreeIndex::setEnable(enable);
+}
+
+// setSrcIndexFile(): with indexing enabled, save the list of files found under the source root of -cutpath
+// in file, and use it instead of walking the tree again in later runs with the same root. Remove the file when
+// the tree changes. nullptr (the default) walks the tree in every run
+
+void Trace::setSrcIndexFile(const char *file)
+{
+	SrcTreeIndex::setIndexFile(file);
+}
+
+// objDumpBenchmark(): time how long the objdump output parser takes on a file of captured objdump output
 
-	status = rc;
+TraceDqr::DQErr Trace::objDumpBenchmark(const char *odTextName)
+{
+	return ObjDump::benchmark(odTextName);
 }
 
-Trace::~Trace()
+// decodeSelfTest(): check the decode lookup tables against the switch based decoder and time both
+
+TraceDqr::DQErr Trace::decodeSelfTest(uint32_t numSamples)
 {
-	cleanUp();
+	return Disassembler::decodeSelfTest(numSamples);
 }
 
 TraceDqr::DQErr Trace::setErrorMode(bool tolerate)
@@ -5596,25 +6649,40 @@ TraceDqr::DQErr Trace::buildElfProcess(const char *elfName)
   processes[0].elfName = new char [l];
   strcpy(processes[0].elfName,elfName);
 
-  processes[0].elfReader = new ElfReader(elfName,objdump,0);
-  if (processes[0].elfReader->getStatus() != TraceDqr::DQERR_OK) {
-    printf("Error: Trace::buildElfProcess(): Error creating ElfReader object\n");
-  
-    status = TraceDqr::DQERR_ERR;
-    return TraceDqr::DQERR_ERR;
+  if (elfCache.isEnabled()) {
+    // the cached ElfReader is already sealed
+
+    processes[0].elfReader = elfCache.getElfReader(elfName,objdump,predecodeLimit);
+    if (processes[0].elfReader == nullptr) {
+      printf("Error: Trace::buildElfProcess(): Error getting ElfReader object from elf cache\n");
+
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
+
+    processes[0].sharedElfReader = true;
   }
+  else {
+    processes[0].elfReader = new ElfReader(elfName,objdump,0);
+    if (processes[0].elfReader->getStatus() != TraceDqr::DQERR_OK) {
+      printf("Error: Trace::buildElfProcess(): Error creating ElfReader object\n");
+  
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
 
-  // this is a bare metal trace. No more elf files or blobs. Go ahead and seal!
-  // sealing will create the symtable object
+    // this is a bare metal trace. No more elf files or blobs. Go ahead and seal!
+    // sealing will create the symtable object
 
-  TraceDqr::DQErr rc;
+    TraceDqr::DQErr rc;
 
-  rc = processes[0].elfReader->seal();
-  if (rc != TraceDqr::DQERR_OK) {
-    printf("Error: Trace::biuldElfProcess(): ElfReader seal failed\n");
+    rc = processes[0].elfReader->seal(predecodeLimit);
+    if (rc != TraceDqr::DQERR_OK) {
+      printf("Error: Trace::biuldElfProcess(): ElfReader seal failed\n");
 
-    status = TraceDqr::DQERR_ERR;
-    return TraceDqr::DQERR_ERR;
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
   }
 
   // get symbol table
@@ -5640,7 +6708,7 @@ TraceDqr::DQErr Trace::buildElfProcess(const char *elfName)
 
   // create disassembler object
 
-  processes[0].disassembler = new (std::nothrow) Disassembler(symtab,sections,processes[0].elfReader->getArchSize());
+  processes[0].disassembler = new (std::nothrow) Disassembler(symtab,sections,processes[0].elfReader->getSectionIndex(),processes[0].elfReader->getArchSize());
   if (processes[0].disassembler == nullptr) {
     printf("Error: Trace::buildElfProcess(): Could not create disassembler object\n");
 
@@ -5659,6 +6727,39 @@ TraceDqr::DQErr Trace::buildElfProcess(const char *elfName)
   return TraceDqr::DQERR_OK;
 }
 
+// elfArchSize(): 32 or 64 from the elf header of elfName, without reading the rest of the file. 0 if the file
+// can't be read or is not an elf file
+
+static int elfArchSize(const char *elfName)
+{
+  FILE *fp;
+
+  fp = fopen(elfName,"rb");
+  if (fp == nullptr) {
+    return 0;
+  }
+
+  uint8_t ident[5];
+  size_t n;
+
+  n = fread(ident,1,sizeof ident,fp);
+
+  fclose(fp);
+
+  if ((n != sizeof ident) || (memcmp(ident,"\177ELF",4) != 0)) {
+    return 0;
+  }
+
+  switch (ident[4]) {
+  case 1:
+    return 32;
+  case 2:
+    return 64;
+  }
+
+  return 0;
+}
+
 TraceDqr::DQErr Trace::buildMFProcesses(const char *nameList)
 {
   if (processes != nullptr) {
@@ -5705,73 +6806,398 @@ TraceDqr::DQErr Trace::buildMFProcesses(const char *nameList)
     processes[i].disassembler = nullptr;
   }
 
-  int pid;
-  int endIndex;
+  // the processes are only built when their pids show up in the trace (see ProcessLoader), so just
+  // save the mapping file names here
+
+  int pid;
+  int endIndex;
+
+  startIndex = 0;
+
+  for (int i = 0; i < numProcesses; i++) {
+    // get pid at startIndex, terminated by ','
+
+    char *endPtr;
+
+    pid = strtoll(&nameList[startIndex],&endPtr,10);
+    if (*endPtr != ',') {
+      printf("Error: Trace::buildMFProcesses(): Incorrect syntax for pid,name pairs\n");
+
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
+
+    processes[i].pid = pid;
+
+    endIndex = endPtr - &nameList[startIndex];
+    startIndex += endIndex+1;
+
+    char mapFileName[1024];
+    int d = 0;
+
+    for (endIndex = startIndex; (nameList[endIndex] != ';') && (nameList[endIndex] != 0); endIndex++) {
+      mapFileName[d] = nameList[endIndex];
+      d += 1;
+    }
+
+    if (startIndex == endIndex) {
+      printf("Error: Trace::buildMFProcesses(): No mapping file name for pid %d\n",pid);
+
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
+
+    mapFileName[d] = 0;
+
+    processes[i].mapFileName = new char [d+1];
+    strcpy(processes[i].mapFileName,mapFileName);
+
+    if (nameList[endIndex] != 0) {
+      startIndex = endIndex+1;
+    }
+    else {
+      startIndex = endIndex;
+    }
+  }
+
+  // the mapping files are read now for the elf file names (the first file in each). The arch size for the
+  // trace comes from the elf file of the first process
+
+  for (int i = 0; i < numProcesses; i++) {
+    addressMap *addrMap = nullptr;
+    int codeSections;
+    TraceDqr::DQErr rc;
+
+    rc = parseMappingFile(processes[i].mapFileName,&addrMap,codeSections);
+    if (rc != TraceDqr::DQERR_OK) {
+      printf("Error: Trace::buildMFProcesses(): Error parsing mapping file %s\n",processes[i].mapFileName);
+
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
+
+    processes[i].elfName = new char [strlen(addrMap->efName)+1];
+    strcpy(processes[i].elfName,addrMap->efName);
+
+    if (i == 0) {
+      archSize = elfArchSize(addrMap->efName);
+    }
+
+    while (addrMap != nullptr) {
+      addressMap *tmpAddrMap = addrMap->next;
+      delete addrMap;
+      addrMap = tmpAddrMap;
+    }
+
+    if (archSize == 0) {
+      printf("Error: Trace::buildMFProcesses(): Could not read the elf header of %s\n",processes[0].elfName);
+
+      status = TraceDqr::DQERR_ERR;
+      return TraceDqr::DQERR_ERR;
+    }
+  }
+
+  return TraceDqr::DQERR_OK;
+}
+
+// configure should probably take a options object that contains the seetings for all the options. Easier to add
+// new options that way without the arg list getting unmanageable
+
+// startup phases of configure() that run at the same time (see runStartupPhases())
+
+struct startupJob {
+	Trace              *trace;
+	TraceSettings      *settings;
+	int                 phase;
+	TraceDqr::DQErr     rc;
+	double              time;
+};
+
+static const char * const startupPhaseNames[] = {
+	"elf files",
+	"trace file",
+	"cycle accurate trace file",
+	"kernel memory",
+	"no-load-strings",
+	"converters",
+};
+
+bool Trace::startupTimes = false;
+
+// setStartupTimes(): print how long each phase of setting up a trace takes, and how long the setup takes
+// in all
+
+void Trace::setStartupTimes(bool enable)
+{
+	startupTimes = enable;
+}
+
+// buildProcesses(): read the elf file of a bare metal trace, or the mapping files of a linux trace
+
+TraceDqr::DQErr Trace::buildProcesses(TraceSettings &settings)
+{
+	TraceDqr::DQErr rc;
+
+	if (settings.efName != nullptr ) {
+		linuxTrace = false;
+
+		if (settings.mfNameList != nullptr) {
+			printf("Error: Trace::buildProcesses(): Cannot set both elf file and mappings file\n");
+
+			status = TraceDqr::DQERR_ERR;
+			return TraceDqr::DQERR_ERR;
+		}
+
+		rc = buildElfProcess(settings.efName);
+        	if (rc != TraceDqr::DQERR_OK) {
+			printf("Error: Trace::buildProcesses(): buildElfProcess() failed\n");
+
+			status = TraceDqr::DQERR_ERR;
+			return TraceDqr::DQERR_ERR;
+		}
+	}
+	else if (settings.mfNameList != nullptr) {
+		linuxTrace = true;
+
+		rc = buildMFProcesses(settings.mfNameList);
+        	if (rc != TraceDqr::DQERR_OK) {
+			printf("Error: Trace::buildProcesses(): parseMFNames() failed\n");
+
+			status = TraceDqr::DQERR_ERR;
+			return TraceDqr::DQERR_ERR;
+		}
+
+		rc = buildPidIndex();
+        	if (rc != TraceDqr::DQERR_OK) {
+			printf("Error: Trace::buildProcesses(): buildPidIndex() failed\n");
+
+			status = TraceDqr::DQERR_ERR;
+			return TraceDqr::DQERR_ERR;
+		}
+
+		// archSize was set from the first process by buildMFProcesses()
+
+		kMem = new KMem(settings.kmemPath, (TraceDqr::ADDRESS)0xffffffff80000000,archSize,objdump);
+
+		processLoader = new (std::nothrow) ProcessLoader(this,settings.tfName,srcbits);
+		if ((processLoader == nullptr) || (processLoader->getStatus() != TraceDqr::DQERR_OK)) {
+			printf("Error: Trace::buildProcesses(): Could not create process loader\n");
+
+			status = TraceDqr::DQERR_ERR;
+			return TraceDqr::DQERR_ERR;
+		}
+	}
+	else {
+		printf("Error: Trace::buildProcesses(): Must specify an elf file or mapping file\n");
+
+		status = TraceDqr::DQERR_ERR;
+		return TraceDqr::DQERR_ERR;
+	}
+
+	return TraceDqr::DQERR_OK;
+}
+
+TraceDqr::DQErr Trace::openTraceFile(TraceSettings &settings)
+{
+	sfp = new (std::nothrow) SliceFileParser(settings.tfName,srcbits);
+
+	if (sfp == nullptr) {
+		printf("Error: Trace::openTraceFile(): Could not create SliceFileParser object\n");
+
+		return TraceDqr::DQERR_ERR;
+	}
+
+	if (sfp->getErr() != TraceDqr::DQERR_OK) {
+		printf("Error: Trace::openTraceFile(): Could not open trace file '%s' for input\n",settings.tfName);
+
+		return TraceDqr::DQERR_ERR;
+	}
+
+	return TraceDqr::DQERR_OK;
+}
+
+// parseNLSStrings(): get the no-load-strings for itc print from the elf file, so setITCPrintOptions()
+// does not need to
+
+TraceDqr::DQErr Trace::parseNLSStrings(TraceSettings &settings)
+{
+	if ((settings.itcPrintOpts == TraceDqr::ITC_OPT_NONE) || (nlsStrings != nullptr) || (currentElfReader[currentCore] == nullptr)) {
+		return TraceDqr::DQERR_OK;
+	}
+
+	TraceDqr::nlStrings *strs;
+
+	strs = new (std::nothrow) TraceDqr::nlStrings[32];
+	if (strs == nullptr) {
+		printf("Error: Trace::parseNLSStrings(): Could not alloacte nslStrings\n");
+		return TraceDqr::DQERR_ERR;
+	}
+
+	for (int i = 0; i < 32; i++) {
+		strs[i].nf = 0;
+		strs[i].signedMask = 0;
+		strs[i].format = nullptr;
+	}
+
+	TraceDqr::DQErr rc;
+
+	rc = currentElfReader[currentCore]->parseNLSStrings(strs);
+	if (rc != TraceDqr::DQERR_OK) {
+		printf("Error: Trace::parseNLSStrings(): ElfReader::parseNLSStrings() failed\n");
+
+		delete [] strs;
+
+		return rc;
+	}
+
+	nlsStrings = strs;
+
+	return TraceDqr::DQERR_OK;
+}
+
+// setupConverters(): create the CTF and perf converters, which create their output files
+
+TraceDqr::DQErr Trace::setupConverters(TraceSettings &settings)
+{
+	TraceDqr::DQErr rc;
+
+	if (settings.CTFConversion != false ) {
+
+		rc = enableCTFConverter(settings.startTime,settings.hostName);
+		if (rc != TraceDqr::DQERR_OK) {
+                  printf("Error: Trace::setupConverters(): enableCTFConverter() failed\n");
+
+			return rc;
+		}
+	}
+
+	if (settings.itcPerfEnable != false) {
+
+		// verify itc print (if enabled) and perf are not using the same channel
+
+		if ((settings.itcPrintChannel == settings.itcPerfChannel) && (settings.itcPrintOpts != TraceDqr::ITC_OPT_NONE) && (settings.itcPrintOpts != TraceDqr::ITC_OPT_NLS)) {
+			printf("Error: Trace::setupConverters(): ITC Print Channel and ITC PerfChannel cannot be the same (%d)\n",settings.itcPrintChannel);
+
+			return TraceDqr::DQERR_ERR;
+		}
+
+		int perfChannel;
+		uint32_t markerValue;
+
+		perfChannel = settings.itcPerfChannel;
+		markerValue = settings.itcPerfMarkerValue;
+
+		rc = enablePerfConverter(perfChannel,markerValue);
+		if (rc != TraceDqr::DQERR_OK) {
+                  printf("Error: Trace::setupConverters(): enablePerfConverter() failed\n");
+
+			return rc;
+		}
+	}
+
 
-  startIndex = 0;
+	return TraceDqr::DQERR_OK;
+}
 
-  for (int i = 0; i < numProcesses; i++) {
-    // get pid at startIndex, terminated by ','
+TraceDqr::DQErr Trace::runStartupPhase(int phase,TraceSettings &settings)
+{
+	TraceDqr::DQErr rc = TraceDqr::DQERR_OK;
 
-    char *endPtr;
+	switch (phase) {
+	case startupProcesses:
+		rc = buildProcesses(settings);
+		break;
+	case startupTraceFile:
+		rc = openTraceFile(settings);
+		break;
+	case startupCATrace:
+		if ((settings.caName != nullptr) && (settings.caType != TraceDqr::CATRACE_NONE)) {
+			caTrace = new (std::nothrow) CATrace(settings.caName,settings.caType);
+			if (caTrace == nullptr) {
+				printf("Error: Trace::runStartupPhase(): Could not create CATrace object\n");
+				rc = TraceDqr::DQERR_ERR;
+			}
+		}
+		break;
+	case startupKMem:
+		if ((kMem != nullptr) && KMem::getPrewarm()) {
+			rc = kMem->prewarm();
+			if (rc != TraceDqr::DQERR_OK) {
+				printf("Error: Trace::runStartupPhase(): KMem::prewarm() failed\n");
+			}
+		}
+		break;
+	case startupNLSStrings:
+		rc = parseNLSStrings(settings);
+		break;
+	case startupConverters:
+		rc = setupConverters(settings);
+		break;
+	default:
+		printf("Error: Trace::runStartupPhase(): Invalid phase %d\n",phase);
+		rc = TraceDqr::DQERR_ERR;
+		break;
+	}
 
-    pid = strtoll(&nameList[startIndex],&endPtr,10);
-    if (*endPtr != ',') {
-      printf("Error: Trace::buildMFProcesses(): Incorrect syntax for pid,name pairs\n");
+	return rc;
+}
 
-      status = TraceDqr::DQERR_ERR;
-      return TraceDqr::DQERR_ERR;
-    }
+void Trace::startupPhaseJob(void *jobs,int j)
+{
+	startupJob *job = &((startupJob *)jobs)[j];
+	Timer timer;
 
-    processes[i].pid = pid;
+	timer.start();
 
-    endIndex = endPtr - &nameList[startIndex];
-    startIndex = endIndex+1;
+	job->rc = job->trace->runStartupPhase(job->phase,*job->settings);
 
-    char mapFileName[1024];
-    int d = 0;
+	job->time = timer.etime();
+}
 
-    for (endIndex = startIndex; (nameList[endIndex] != ';') && (nameList[endIndex] != 0); endIndex++) {
-      mapFileName[d] = nameList[endIndex];
-      d += 1;
-    }
+// runStartupPhases(): run phases that don't depend on each other at the same time. Each phase sets
+// different members, and only one phase of a set may set status. Returns the error of the first phase
+// in the list that failed
 
-    if (startIndex == endIndex) {
-      printf("Error: Trace::buildMFProcesses(): No mapping file name for pid %d\n",pid);
+TraceDqr::DQErr Trace::runStartupPhases(const int *phases,int numPhases,TraceSettings &settings)
+{
+	startupJob jobs[sizeof startupPhaseNames / sizeof startupPhaseNames[0]];
 
-      status = TraceDqr::DQERR_ERR;
-      return TraceDqr::DQERR_ERR;
-    }
+	if ((size_t)numPhases > sizeof jobs / sizeof jobs[0]) {
+		printf("Error: Trace::runStartupPhases(): Too many phases\n");
+		return TraceDqr::DQERR_ERR;
+	}
 
-    mapFileName[d] = 0;
+	for (int i = 0; i < numPhases; i++) {
+		jobs[i].trace = this;
+		jobs[i].settings = &settings;
+		jobs[i].phase = phases[i];
+		jobs[i].rc = TraceDqr::DQERR_OK;
+		jobs[i].time = 0.0;
+	}
 
-    TraceDqr::DQErr rc;
+	runJobs(numPhases,startupPhaseJob,jobs);
 
-    rc = buildProcess(&processes[i],pid,mapFileName);
-    if (rc != TraceDqr::DQERR_OK) {
-      printf("Error: Trace::buildMFProcesses(): buildProcess() failed\n");
+	TraceDqr::DQErr rc = TraceDqr::DQERR_OK;
 
-      status = TraceDqr::DQERR_ERR;
-      return TraceDqr::DQERR_ERR;
-    }
+	for (int i = 0; i < numPhases; i++) {
+		if (startupTimes) {
+			printf("Info: Startup phase %s took %.3f seconds\n",startupPhaseNames[jobs[i].phase],jobs[i].time);
+		}
 
-    if (nameList[endIndex] != 0) {
-      startIndex = endIndex+1;
-    }
-    else {
-      startIndex = endIndex;
-    }
-  }
+		if ((rc == TraceDqr::DQERR_OK) && (jobs[i].rc != TraceDqr::DQERR_OK)) {
+			rc = jobs[i].rc;
+		}
+	}
 
-  return TraceDqr::DQERR_OK;
+	return rc;
 }
 
-// configure should probably take a options object that contains the seetings for all the options. Easier to add
-// new options that way without the arg list getting unmanageable
-
 TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 {
 	TraceDqr::DQErr rc;
+	Timer startupTimer;
+
+	startupTimer.start();
 
 	status = TraceDqr::DQERR_OK;
 
@@ -5782,6 +7208,9 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	numPids      = 0;
 	pidList      = nullptr;
 	kMem         = nullptr;
+	processLoader = nullptr;
+	pidIndex     = nullptr;
+	pidIndexMask = 0;
 	caTrace      = nullptr;
 	counts       = nullptr;//delete this line if compile error
         mfNameList   = nullptr;
@@ -5794,6 +7223,7 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	objdump       = nullptr;
 	bitsPerAddress = 0;
 	archSize      = 0;
+	predecodeLimit = 0;
 	traceType     = TraceDqr::TRACETYPE_BTM;
 	tolerateErrors = true;
 	tolerantError = false;
@@ -5819,6 +7249,8 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	caSyncAddr = (TraceDqr::ADDRESS)-1;
 
 	tolerateErrors = settings.tolerateErrors;
+	predecodeLimit = (uint64_t)settings.predecodeLimit * 1024 * 1024;
+
 	if (settings.odName != nullptr) {
 		int len;
 
@@ -5875,22 +7307,6 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	rtdName = new char[strlen(settings.tfName)+1];
 	strcpy(rtdName,settings.tfName);
 
-	sfp = new (std::nothrow) SliceFileParser(settings.tfName,srcbits);
-
-	if (sfp == nullptr) {
-		printf("Error: Trace::configure(): Could not create SliceFileParser object\n");
-
-		status = TraceDqr::DQERR_ERR;
-		return TraceDqr::DQERR_ERR;
-	}
-
-	if (sfp->getErr() != TraceDqr::DQERR_OK) {
-		printf("Error: Trace::configure(): Could not open trace file '%s' for input\n",settings.tfName);
-
-		status = TraceDqr::DQERR_ERR;
-		return TraceDqr::DQERR_ERR;
-	}
-
 	if (settings.pids != nullptr) {
 		// pids is to specify what pids to trace??
 
@@ -5907,47 +7323,23 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
           numPids = 0;
         }
 
-	if (settings.efName != nullptr ) {
-		linuxTrace = false;
-
-		if (settings.mfNameList != nullptr) {
-			printf("Error: Trace::configure(): Cannot set both elf file and mappings file\n");
-
-			status = TraceDqr::DQERR_ERR;
-			return TraceDqr::DQERR_ERR;
-		}
-
-		rc = buildElfProcess(settings.efName);
-        	if (rc != TraceDqr::DQERR_OK) {
-			printf("Error: Trace::configure(): buildElfProcess() failed\n");
-
-			status = TraceDqr::DQERR_ERR;
-			return TraceDqr::DQERR_ERR;
-		}
-	}
-	else if (settings.mfNameList != nullptr) {
-		linuxTrace = true;
-
-		rc = buildMFProcesses(settings.mfNameList);
-        	if (rc != TraceDqr::DQERR_OK) {
-			printf("Error: Trace::configure(): parseMFNames() failed\n");
-
-			status = TraceDqr::DQERR_ERR;
-			return TraceDqr::DQERR_ERR;
-		}
-
-		archSize = processes[0].elfReader->getArchSize();
+	// the elf files (or mapping files), the trace file, and the cycle accurate trace file don't depend on each
+	// other, so they are read at the same time
 
-		kMem = new KMem(settings.kmemPath, (TraceDqr::ADDRESS)0xffffffff80000000,archSize,objdump);
-	}
-	else {
-		printf("Error: Trace::configure(): Must specify an elf file or mapping file\n");
+	static const int readPhases[] = { startupProcesses, startupTraceFile, startupCATrace };
 
-		status = TraceDqr::DQERR_ERR;
-		return TraceDqr::DQERR_ERR;
+	rc = runStartupPhases(readPhases,sizeof readPhases / sizeof readPhases[0],settings);
+	if (rc != TraceDqr::DQERR_OK) {
+		status = rc;
+		return rc;
 	}
 
         for (int i = 0; i < numProcesses; i++) {
+          if (processes[i].disassembler == nullptr) {
+            // not built yet. The process loader sets the path type when it is
+            continue;
+          }
+
           rc = processes[i].disassembler->setPathType(settings.pathType);
           if (rc != TraceDqr::DQERR_OK) {
             printf("Error: Trace::configure(): setPathType() failed\n");
@@ -6014,6 +7406,8 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
           currentElfReader[i] = processes[0].elfReader;
         }
 
+	resetProcCache(-1);
+
 	for (int i = 0; (size_t)i < sizeof lastTime / sizeof lastTime[0]; i++) {
 		lastTime[i] = 0;
 	}
@@ -6033,22 +7427,21 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	instructionInfo.instruction = 0;
 	instructionInfo.instSize = 0;
 
+	// the processes of linux traces are built when the trace first reaches them, so use getAddressSize(),
+	// which falls back to the arch size of the trace (from the settings or the kernel elf file)
+
 	if (settings.numAddrBits != 0 ) {
-		instructionInfo.addrSize = settings.numAddrBits;
+		dispAddrSize() = settings.numAddrBits;
 		bitsPerAddress = settings.numAddrBits;
 	}
-	else if (processes[0].elfReader == nullptr) {
-		instructionInfo.addrSize = 0;
-		bitsPerAddress = 0;
-	}
 	else {
-		instructionInfo.addrSize = processes[0].elfReader->getBitsPerAddress();
-		bitsPerAddress = processes[0].elfReader->getBitsPerAddress();
+		dispAddrSize() = getAddressSize(-1);
+		bitsPerAddress = getAddressSize(-1);
 	}
 
-	instructionInfo.addrDispFlags = settings.addrDispFlags;
+	dispAddrDispFlags() = settings.addrDispFlags;
 
-	instructionInfo.addrPrintWidth = (instructionInfo.addrSize + 3) / 4;
+	dispAddrPrintWidth() = (dispAddrSize() + 3) / 4;
 
 	instructionInfo.addressLabel = nullptr;
 	instructionInfo.addressLabelOffset = 0;
@@ -6065,7 +7458,7 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	sourceInfo.sourceLine = nullptr;
 
 	freq = settings.freq;
-	NexusMessage::targetFrequency = settings.freq;
+	dispTargetFrequency() = settings.freq;
 
 	tsSize = settings.tsSize;
 
@@ -6073,6 +7466,17 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 		enterISR[i] = TraceDqr::isNone;
 	}
 
+	// with the elf file read, kernel memory, the no-load-strings, and the converter output files can be set
+	// up at the same time
+
+	static const int setupPhases[] = { startupKMem, startupNLSStrings, startupConverters };
+
+	rc = runStartupPhases(setupPhases,sizeof setupPhases / sizeof setupPhases[0],settings);
+	if (rc != TraceDqr::DQERR_OK) {
+		status = rc;
+		return rc;
+	}
+
 	if (settings.itcPrintOpts != TraceDqr::ITC_OPT_NONE) {
 		rc = setITCPrintOptions(settings.itcPrintOpts,settings.itcPrintBufferSize,settings.itcPrintChannel);
 		if (rc != TraceDqr::DQERR_OK) {
@@ -6084,7 +7488,7 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 	}
 
 	if ((settings.caName != nullptr) && (settings.caType != TraceDqr::CATRACE_NONE)) {
-		rc = setCATraceFile(settings.caName,settings.caType);
+		rc = startCATrace();
 		if (rc != TraceDqr::DQERR_OK) {
                   printf("Error: Trace::configure(): setCATraceFile() failed\n");
 
@@ -6093,19 +7497,6 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 		}
 	}
 
-	if (settings.CTFConversion != false ) {
-
-		// Do the code below only after setting efName above
-
-		rc = enableCTFConverter(settings.startTime,settings.hostName);
-		if (rc != TraceDqr::DQERR_OK) {
-                  printf("Error: Trace::configure(): enableCTFConverter() failed\n");
-
-			status = rc;
-			return status;
-		}
-	}
-
 	if (settings.eventConversionEnable != false) {
 
 		// Do the code below only after setting efName above
@@ -6113,34 +7504,6 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 		eventConvert = true;
 	}
 
-	if (settings.itcPerfEnable != false) {
-
-		// verify itc print (if enabled) and perf are not using the same channel
-
-		if ((settings.itcPrintChannel == settings.itcPerfChannel) && (settings.itcPrintOpts != TraceDqr::ITC_OPT_NONE) && (settings.itcPrintOpts != TraceDqr::ITC_OPT_NLS)) {
-			printf("Error: Trace::configure(): ITC Print Channel and ITC PerfChannel cannot be the same (%d)\n",settings.itcPrintChannel);
-
-			status = TraceDqr::DQERR_ERR;
-			return status;
-		}
-
-		// Do the code below only after setting efName above
-
-		int perfChannel;
-		uint32_t markerValue;
-
-		perfChannel = settings.itcPerfChannel;
-		markerValue = settings.itcPerfMarkerValue;
-
-		rc = enablePerfConverter(perfChannel,markerValue);
-		if (rc != TraceDqr::DQERR_OK) {
-                  printf("Error: Trace::configure(): enablePerfConverter() failed\n");
-
-			status = rc;
-			return status;
-		}
-	}
-
 	if ((settings.cutPath != nullptr) || (settings.srcRoot != nullptr)) {
 		rc = subSrcPath(settings.cutPath,settings.srcRoot);
 		if (rc != TraceDqr::DQERR_OK) {
@@ -6152,6 +7515,10 @@ TraceDqr::DQErr Trace::configure(TraceSettings &settings)
 		}
 	}
 
+	if (startupTimes) {
+		printf("Info: Trace setup took %.3f seconds\n",startupTimer.etime());
+	}
+
 	return status;
 }
 
@@ -6186,6 +7553,13 @@ void Trace::cleanUp()
 		}
 	}
 
+	// the prescan thread uses the trace settings and processes, so stop it first
+
+	if (processLoader != nullptr) {
+		delete processLoader;
+		processLoader = nullptr;
+	}
+
 	if (objdump != nullptr) {
 		delete [] objdump;
 		objdump = nullptr;
@@ -6205,6 +7579,11 @@ void Trace::cleanUp()
           pidList = nullptr;
 	}
 
+	if (pidIndex != nullptr) {
+          delete [] pidIndex;
+          pidIndex = nullptr;
+	}
+
         for (int i = 0; (size_t)i < sizeof currentElfReader / sizeof currentElfReader[0]; i++) {
           // don't delete! It gets deleted elsewere
 
@@ -6303,11 +7682,13 @@ pidMap *Trace::getPidMap(int &num_pids)
   for (int i = 0; i < num_pids; i++) {
     pm[i].pid = processes[i].pid;
 
-    if (processes[i].elfReader != nullptr) {
+    // linux processes have their elf name before they are built
+
+    if (processes[i].elfName != nullptr) {
       int l;
       const char *en;
 
-      en = processes[i].elfReader->getElfName();
+      en = processes[i].elfName;
       if ((en[0] == '.') && (en[1] == '/')) {
         en += 1;
       }
@@ -6352,39 +7733,161 @@ TraceDqr::DQErr Trace::parsePidList(const char *pids)
   int l;
   l = strlen(pids) + 1;
 
-  // count the number of pids specified
+  // count the number of pids specified
+
+  numPids = 1;
+
+  for (int i = 0; i < l; i++) {
+    if (pids[i] == ',') {
+      numPids += 1;
+    }
+  }
+
+  pidList = new int[numPids];
+
+  const char *start;
+  char *end;
+
+  start = pids;
+
+  for (int i = 0; i < numPids; i++) {
+    pidList[i] = strtol(start,&end,10);
+    if (start == end) {
+      printf("Error: TraceSettings::parsePidList(): pids syntax error\n");
+      return TraceDqr::DQERR_ERR;
+    }
+
+    if ((*end != ',') && (*end != 0)) {
+      printf("Error: TraceSettings::parsePidList(): pids syntax error\n");
+      return TraceDqr::DQERR_ERR;
+    }
+
+    start = end+1;
+  }
+
+  return TraceDqr::DQERR_OK;
+}
+
+static inline uint32_t hashPid(int pid)
+{
+  return (uint32_t)pid * 2654435761u;
+}
+
+// buildPidIndex(): hash the pids of the linux processes so processPidPriv() can find the process for a
+// pid without searching the pid list and process array. Processes whose pids are filtered out by the pid
+// list are left out, so a miss means the pid is not decoded. If two mapping files have the same pid, the
+// first one is used
+
+TraceDqr::DQErr Trace::buildPidIndex()
+{
+  if (pidIndex != nullptr) {
+    delete [] pidIndex;
+    pidIndex = nullptr;
+  }
+
+  uint32_t size;
+
+  // keep the table at most half full
+
+  for (size = 8; size < (uint32_t)numProcesses * 2; size *= 2) {
+    // empty
+  }
+
+  pidIndex = new (std::nothrow) int[size];
+  if (pidIndex == nullptr) {
+    printf("Error: Trace::buildPidIndex(): Could not allocate pid index\n");
+    return TraceDqr::DQERR_ERR;
+  }
+
+  pidIndexMask = size - 1;
+
+  for (uint32_t i = 0; i < size; i++) {
+    pidIndex[i] = -1;
+  }
+
+  for (int i = 0; i < numProcesses; i++) {
+    int pid = processes[i].pid;
+
+    if (numPids > 0) {
+      bool wanted = false;
+
+      for (int j = 0; (j < numPids) && !wanted; j++) {
+        wanted = (pidList[j] == pid);
+      }
+
+      if (!wanted) {
+        continue;
+      }
+    }
+
+    uint32_t h;
+
+    for (h = hashPid(pid) & pidIndexMask; (pidIndex[h] != -1) && (processes[pidIndex[h]].pid != pid); h = (h + 1) & pidIndexMask) {
+      // probe
+    }
+
+    if (pidIndex[h] == -1) {
+      pidIndex[h] = i;
+    }
+  }
+
+  return TraceDqr::DQERR_OK;
+}
+
+// findProcess(): return the index into processes of the process used to decode pid, or -1 if the pid is
+// not being decoded or has no process. Does not build the process
+
+int Trace::findProcess(int pid)
+{
+  if (processes[0].pid == -1) {
+    // bare metal trace. All pids use process 0
+
+    if (numPids == 0) {
+      return 0;
+    }
+
+    for (int i = 0; i < numPids; i++) {
+      if (pidList[i] == pid) {
+        return 0;
+      }
+    }
 
-  numPids = 1;
+    return -1;
+  }
 
-  for (int i = 0; i < l; i++) {
-    if (pids[i] == ',') {
-      numPids += 1;
+  if (pidIndex == nullptr) {
+    return -1;
+  }
+
+  for (uint32_t h = hashPid(pid) & pidIndexMask; pidIndex[h] != -1; h = (h + 1) & pidIndexMask) {
+    if (processes[pidIndex[h]].pid == pid) {
+      return pidIndex[h];
     }
   }
 
-  pidList = new int[numPids];
+  return -1;
+}
 
-  const char *start;
-  char *end;
+// resetProcCache(): forget the recently active processes for core (all cores if core < 0). For bare metal
+// traces the current context is process 0 with pid 0, matching currentPid and currentProcessIndex
 
-  start = pids;
+void Trace::resetProcCache(int core)
+{
+  int first = (core < 0) ? 0 : core;
+  int last = (core < 0) ? DQR_MAXCORES-1 : core;
 
-  for (int i = 0; i < numPids; i++) {
-    pidList[i] = strtol(start,&end,10);
-    if (start == end) {
-      printf("Error: TraceSettings::parsePidList(): pids syntax error\n");
-      return TraceDqr::DQERR_ERR;
+  for (int c = first; c <= last; c++) {
+    for (int i = 0; i < procCacheSize; i++) {
+      procCache[c][i].pid = -1;
+      procCache[c][i].processIndex = -2;
+      procCache[c][i].sectionHint = -1;
     }
 
-    if ((*end != ',') && (*end != 0)) {
-      printf("Error: TraceSettings::parsePidList(): pids syntax error\n");
-      return TraceDqr::DQERR_ERR;
+    if ((processes != nullptr) && (processes[0].pid == -1)) {
+      procCache[c][0].pid = 0;
+      procCache[c][0].processIndex = 0;
     }
-
-    start = end+1;
   }
-
-  return TraceDqr::DQERR_OK;
 }
 
 addressMap::addressMap(const char *name,TraceDqr::elfType e_type,bool is_blob,uint64_t start,uint64_t end)
@@ -6748,33 +8251,26 @@ TraceDqr::DQErr Trace::parseMappingFile(const char *fName,class addressMap **am,
 
 TraceDqr::DQErr Trace::buildProcess(process *process,int pid,const char *mapFileName)
 {
-  // create a process entry for process
+  // create a process entry for process. May be called by the prescan thread of the process loader, so
+  // only reads the Trace object
 
   if (process == nullptr) {
     printf("Error: Trace::buildProcess(): process argument null\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
   if (mapFileName == nullptr) {
     printf("Error: Trace::buildProcess(): mapFileName argument null\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
   if (process->elfReader != nullptr) {
     printf("Error: Trace::buildProcess(): process has already be created\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
   if (pid < 0) {
     printf("Error: buildProcessArray(): Invalid pid (%d)\n",pid);
-    
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
@@ -6785,8 +8281,6 @@ TraceDqr::DQErr Trace::buildProcess(process *process,int pid,const char *mapFile
   rc = parseMappingFile(mapFileName,&addrMap,codeSections);
   if (rc != TraceDqr::DQERR_OK) {
     printf("Error: buildProcess(): Error parsing mapping file %s\n",mapFileName);
-    
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
@@ -6810,12 +8304,14 @@ TraceDqr::DQErr Trace::buildProcess(process *process,int pid,const char *mapFile
 
   if (process->elfReader->getStatus() != TraceDqr::DQERR_OK) {
     printf("Error: buildProcess(): Error creating elfReader object\n");
-    status = TraceDqr::DQERR_ERR;
-    return TraceDqr::DQERR_ERR;
-  }
 
-  if (archSize == 0) {
-    archSize = process->elfReader->getArchSize();
+    while (addrMap != nullptr) {
+      addressMap *tmpAddrMap = addrMap->next;
+      delete addrMap;
+      addrMap = tmpAddrMap;
+    }
+
+    return TraceDqr::DQERR_ERR;
   }
 
   addressMap *tmpAddrMap;
@@ -6824,28 +8320,24 @@ TraceDqr::DQErr Trace::buildProcess(process *process,int pid,const char *mapFile
   delete addrMap;
   addrMap = tmpAddrMap;
 
-  while (addrMap != nullptr) {
-
-    // all files after the elf file will either be blobs or shared libraries
+  // all files after the elf file will either be blobs or shared libraries. They are loaded in parallel
 
-    rc = process->elfReader->addElfFile(addrMap->efName,addrMap,objdump);
-    if (rc != TraceDqr::DQERR_OK) {
-      printf("Error: buildProcess(): Could not add elf file %s to ElfReader object\n",mapFileName);
-    
-      status = TraceDqr::DQERR_ERR;
-      return TraceDqr::DQERR_ERR;
-    }
+  rc = process->elfReader->addElfFiles(addrMap,objdump);
 
+  while (addrMap != nullptr) {
     tmpAddrMap = addrMap->next;
     delete addrMap;
     addrMap = tmpAddrMap;
   }
 
-  rc = process->elfReader->seal();
+  if (rc != TraceDqr::DQERR_OK) {
+    printf("Error: buildProcess(): Could not add elf files from %s to ElfReader object\n",mapFileName);
+    return TraceDqr::DQERR_ERR;
+  }
+
+  rc = process->elfReader->seal(predecodeLimit);
   if (rc != TraceDqr::DQERR_OK) {
     printf("Error: buildProcess(): ElfReader seal failed\n");
-    
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
@@ -6857,33 +8349,25 @@ TraceDqr::DQErr Trace::buildProcess(process *process,int pid,const char *mapFile
   symtab = process->elfReader->getSymtab();
   if (symtab == nullptr) {
     printf("Error: buildProcess(): Could not get symbol table\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
   sections = process->elfReader->getSections();
   if (sections == nullptr) {
     printf("Error: buildProcess(): Could not get sections\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
   // create disassembler object
 
-  process->disassembler = new (std::nothrow) Disassembler(symtab,sections,process->elfReader->getArchSize());
+  process->disassembler = new (std::nothrow) Disassembler(symtab,sections,process->elfReader->getSectionIndex(),process->elfReader->getArchSize());
   if (process->disassembler == nullptr) {
     printf("Error: Trace::buildProcess(): Could not create disassembler object\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
   if (process->disassembler->getStatus() != TraceDqr::DQERR_OK) {
     printf("Error: Trace::buildProcess(): Could not create disassembler object\n");
-
-    status = TraceDqr::DQERR_ERR;
     return TraceDqr::DQERR_ERR;
   }
 
@@ -6912,12 +8396,22 @@ int Trace::getArchSize(int pid)
 		return 0;
 	}
 
+	// processes of linux traces that have not been built yet have the arch size of the trace
+
 	if (pid == -1) {
+		if (processes[0].elfReader == nullptr) {
+			return archSize;
+		}
+
 		return processes[0].elfReader->getArchSize();
 	}
 
 	for (int i = 0; i < numProcesses; i++) {
 		if (processes[i].pid == pid) {
+			if (processes[i].elfReader == nullptr) {
+				return archSize;
+			}
+
 			return processes[i].elfReader->getArchSize();
 		}
 	}
@@ -6931,12 +8425,22 @@ int Trace::getAddressSize(int pid)
 		return 0;
 	}
 
+	// processes of linux traces that have not been built yet have the arch size of the trace
+
 	if (pid == -1) {
+		if (processes[0].elfReader == nullptr) {
+			return archSize;
+		}
+
 		return processes[0].elfReader->getBitsPerAddress();
 	}
 
 	for (int i = 0; i < numProcesses; i++) {
 		if (processes[i].pid == pid) {
+			if (processes[i].elfReader == nullptr) {
+				return archSize;
+			}
+
 			return processes[i].elfReader->getBitsPerAddress();
 		}
 	}
@@ -6967,7 +8471,14 @@ TraceDqr::DQErr Trace::setPathType(TraceDqr::pathType pt)
 
 	TraceDqr::DQErr rc;
 
-	rc = TraceDqr::DQERR_ERR;
+	// processes the process loader has not built yet get the path type when they are installed
+
+	if (processLoader != nullptr) {
+		rc = TraceDqr::DQERR_OK;
+	}
+	else {
+		rc = TraceDqr::DQERR_ERR;
+	}
 
 	for (int i = 0; i < numProcesses; i++) {
 		if (processes[i].disassembler != nullptr) {
@@ -7015,7 +8526,15 @@ TraceDqr::DQErr Trace::subSrcPath(const char *cutPath,const char *newRoot)
 	}
 
 	TraceDqr::DQErr rc;
-	rc = TraceDqr::DQERR_ERR;
+
+	// processes the process loader has not built yet get cutPath and newRoot when they are installed
+
+	if (processLoader != nullptr) {
+		rc = TraceDqr::DQERR_OK;
+	}
+	else {
+		rc = TraceDqr::DQERR_ERR;
+	}
 
 	for (int i = 0; i < numProcesses; i++) {
 		if (processes[i].disassembler != nullptr) {
@@ -7039,6 +8558,13 @@ TraceDqr::DQErr Trace::setCATraceFile( char *caf_name,TraceDqr::CATraceType caty
 {
 	caTrace = new CATrace(caf_name,catype);
 
+	return startCATrace();
+}
+
+// startCATrace(): sync the cycle accurate trace in caTrace with the trace file
+
+TraceDqr::DQErr Trace::startCATrace()
+{
 	TraceDqr::DQErr rc;
 	rc = caTrace->getStatus();
 	if (rc != TraceDqr::DQERR_OK) {
@@ -7277,7 +8803,7 @@ TraceDqr::DQErr Trace::getInstructionByAddress(TraceDqr::ADDRESS addr,TraceDqr::
     }
   }
   else {
-    rc = currentElfReader[currentCore]->getInstructionByAddress(addr,inst);
+    rc = currentElfReader[currentCore]->getInstructionByAddress(addr,inst,procCache[currentCore][0].sectionHint);
     if (rc != TraceDqr::DQERR_OK) {
       return TraceDqr::DQERR_ERR;
     }
@@ -7286,6 +8812,59 @@ TraceDqr::DQErr Trace::getInstructionByAddress(TraceDqr::ADDRESS addr,TraceDqr::
   return TraceDqr::DQERR_OK;
 }
 
+// getPredecodedInstByAddress(): get the decode results for the instruction at addr from the elf file's
+// predecode tables. If addr is not covered by a predecode table (kmem, tables disabled or over
+// the size limit), the instruction is fetched and decoded here
+
+TraceDqr::DQErr Trace::getPredecodedInstByAddress(TraceDqr::ADDRESS addr,predecodedInst &pdi)
+{
+  if ((kMem == nullptr) || (addr < kMem->getKStart())) {
+    const predecodedInst *pdip;
+
+    pdip = currentElfReader[currentCore]->getPredecodedInstByAddress(addr,procCache[currentCore][0].sectionHint);
+    if (pdip != nullptr) {
+      pdi = *pdip;
+      return TraceDqr::DQERR_OK;
+    }
+  }
+
+  TraceDqr::DQErr ec;
+  uint32_t inst;
+  int inst_size;
+  TraceDqr::InstType inst_type;
+  TraceDqr::Reg rs1;
+  TraceDqr::Reg rd;
+  int32_t immediate;
+  bool is_branch;
+  int crFlag;
+  int brFlag;
+
+  ec = getInstructionByAddress(addr,inst);
+  if (ec != TraceDqr::DQERR_OK) {
+    return ec;
+  }
+
+  if (decodeInstruction(inst,inst_size,inst_type,rs1,rd,immediate,is_branch) != 0) {
+    printf("Error: Trace::getPredecodedInstByAddress(): Cannot decode instruction %04x\n",inst);
+
+    status = TraceDqr::DQERR_ERR;
+    return TraceDqr::DQERR_ERR;
+  }
+
+  Disassembler::getCRBRFlags(inst_type,rs1,rd,crFlag,brFlag);
+
+  pdi.inst_size = (uint8_t)inst_size;
+  pdi.inst_type = (uint8_t)inst_type;
+  pdi.rs1 = (int8_t)rs1;
+  pdi.rd = (int8_t)rd;
+  pdi.crFlag = (uint8_t)crFlag;
+  pdi.brFlag = (uint8_t)brFlag;
+  pdi.is_branch = is_branch;
+  pdi.immediate = immediate;
+
+  return TraceDqr::DQERR_OK;
+}
+
 TraceDqr::DQErr Trace::Disassemble(TraceDqr::ADDRESS addr)
 {
 	TraceDqr::DQErr rc;
@@ -7308,7 +8887,7 @@ TraceDqr::DQErr Trace::Disassemble(TraceDqr::ADDRESS addr)
 		return TraceDqr::DQERR_ERR;
 	}
 	else {
-		rc = currentDisassembler[currentCore]->disassemble(addr);
+		rc = currentDisassembler[currentCore]->disassemble(addr,currentCore);
 		if (rc != TraceDqr::DQERR_OK) {
 		  return TraceDqr::DQERR_ERR;
 		}
@@ -7435,9 +9014,9 @@ std::string Trace::getITCPrintStr(int core, bool &haveData,double &startTime,dou
 		haveData = itcPrint->getITCPrintStr(core,s,sts,ets);
 
 		if (haveData != false) {
-			if (NexusMessage::targetFrequency != 0) {
-				startTime = ((double)sts)/NexusMessage::targetFrequency;
-				endTime = ((double)ets)/NexusMessage::targetFrequency;
+			if (freq != 0) {
+				startTime = ((double)sts)/freq;
+				endTime = ((double)ets)/freq;
 			}
 			else {
 				startTime = sts;
@@ -7475,9 +9054,9 @@ std::string Trace::flushITCPrintStr(int core, bool &haveData,double &startTime,d
 		haveData = itcPrint->flushITCPrintStr(core,s,sts,ets);
 
 		if (haveData != false) {
-			if (NexusMessage::targetFrequency != 0) {
-				startTime = ((double)sts)/NexusMessage::targetFrequency;
-				endTime = ((double)ets)/NexusMessage::targetFrequency;
+			if (freq != 0) {
+				startTime = ((double)sts)/freq;
+				endTime = ((double)ets)/freq;
 			}
 			else {
 				startTime = sts;
@@ -7494,15 +9073,8 @@ std::string Trace::flushITCPrintStr(int core, bool &haveData,double &startTime,d
 
 TraceDqr::DQErr Trace::getCRBRFlags(TraceDqr::ICTReason cksrc,TraceDqr::ADDRESS addr,int &crFlag,int &brFlag)
 {
-	int rc;
 	TraceDqr::DQErr ec;
-	uint32_t inst;
-	int inst_size;
-	TraceDqr::InstType inst_type;
-	int32_t immediate;
-	bool isBranch;
-	TraceDqr::Reg rs1;
-	TraceDqr::Reg rd;
+	predecodedInst pdi;
 
 	//	Need to get the destination of the call, which is in the immediate field
 
@@ -7516,7 +9088,7 @@ TraceDqr::DQErr Trace::getCRBRFlags(TraceDqr::ICTReason cksrc,TraceDqr::ADDRESS
 	case TraceDqr::ICT_PC_SAMPLE:
 		break;
 	case TraceDqr::ICT_INFERABLECALL:
-		ec = getInstructionByAddress(addr,inst);
+		ec = getPredecodedInstByAddress(addr,pdi);
 		if (ec != TraceDqr::DQERR_OK) {
 			printf("Error: getCRBRFlags() failed\n");
 
@@ -7524,68 +9096,8 @@ TraceDqr::DQErr Trace::getCRBRFlags(TraceDqr::ICTReason cksrc,TraceDqr::ADDRESS
 			return ec;
 		}
 
-		rc = decodeInstruction(inst,inst_size,inst_type,rs1,rd,immediate,isBranch);
-		if (rc != 0) {
-			printf("Error: getCRBRFlags(): Cann't decode size of instruction %04x\n",inst);
-
-			status = TraceDqr::DQERR_ERR;
-			return TraceDqr::DQERR_ERR;
-		}
-
-		switch (inst_type) {
-		case TraceDqr::INST_JALR:
-			if ((rd == TraceDqr::REG_1) || (rd == TraceDqr::REG_5)) { // rd == link
-				if ((rs1 != TraceDqr::REG_1) && (rs1 != TraceDqr::REG_5)) { // rd == link; rs1 != link
-					crFlag = TraceDqr::isCall;
-				}
-				else if (rd != rs1) { // rd == link; rs1 == link; rd != rs1
-					crFlag = TraceDqr::isSwap;
-				}
-				else { // rd == link; rs1 == link; rd == rs1
-					crFlag = TraceDqr::isCall;
-				}
-			}
-			else if ((rs1 == TraceDqr::REG_1) || (rs1 == TraceDqr::REG_5)) { // rd != link; rs1 == link
-				crFlag = TraceDqr::isReturn;
-			}
-			break;
-		case TraceDqr::INST_JAL:
-			if ((rd == TraceDqr::REG_1) || (rd == TraceDqr::REG_5)) { // rd == link
-				crFlag = TraceDqr::isCall;
-			}
-			break;
-		case TraceDqr::INST_C_JAL:
-			if ((rd == TraceDqr::REG_1) || (rd == TraceDqr::REG_5)) { // rd == link
-				crFlag = TraceDqr::isCall;
-			}
-			break;
-		case TraceDqr::INST_C_JR:
-			if ((rs1 == TraceDqr::REG_1) || (rs1 == TraceDqr::REG_5)) {
-				crFlag = TraceDqr::isReturn;
-			}
-			break;
-		case TraceDqr::INST_EBREAK:
-		case TraceDqr::INST_ECALL:
-			crFlag = TraceDqr::isException;
-			break;
-		case TraceDqr::INST_MRET:
-		case TraceDqr::INST_SRET:
-		case TraceDqr::INST_URET:
-			crFlag = TraceDqr::isExceptionReturn;
-			break;
-		case TraceDqr::INST_BEQ:
-		case TraceDqr::INST_BNE:
-		case TraceDqr::INST_BLT:
-		case TraceDqr::INST_BGE:
-		case TraceDqr::INST_BLTU:
-		case TraceDqr::INST_BGEU:
-		case TraceDqr::INST_C_BEQZ:
-		case TraceDqr::INST_C_BNEZ:
-			brFlag = TraceDqr::BRFLAG_taken;
-			break;
-		default:
-			break;
-		}
+		crFlag = pdi.crFlag;
+		brFlag = pdi.brFlag;
 		break;
 	case TraceDqr::ICT_EXCEPTION:
 		crFlag = TraceDqr::isException;
@@ -7611,17 +9123,14 @@ TraceDqr::DQErr Trace::getCRBRFlags(TraceDqr::ICTReason cksrc,TraceDqr::ADDRESS
 
 TraceDqr::DQErr Trace::nextAddr(TraceDqr::ADDRESS addr,TraceDqr::ADDRESS &nextAddr,int &crFlag)
 {
-	int rc;
 	TraceDqr::DQErr ec;
-	uint32_t inst;
-	int inst_size;
+	predecodedInst pdi;
 	TraceDqr::InstType inst_type;
 	int32_t immediate;
-	bool isBranch;
 	TraceDqr::Reg rs1;
 	TraceDqr::Reg rd;
 
-	ec = getInstructionByAddress(addr,inst);
+	ec = getPredecodedInstByAddress(addr,pdi);
 	if (ec != TraceDqr::DQERR_OK) {
 		printf("Error: nextAddr() failed\n");
 
@@ -7634,13 +9143,10 @@ TraceDqr::DQErr Trace::nextAddr(TraceDqr::ADDRESS addr,TraceDqr::ADDRESS &nextAd
 	crFlag = TraceDqr::isNone;
 	nextAddr = 0;
 
-	rc = decodeInstruction(inst,inst_size,inst_type,rs1,rd,immediate,isBranch);
-	if (rc != 0) {
-		printf("Error: Cann't decode size of instruction %04x\n",inst);
-
-		status = TraceDqr::DQERR_ERR;
-		return TraceDqr::DQERR_ERR;
-	}
+	inst_type = (TraceDqr::InstType)pdi.inst_type;
+	rs1 = (TraceDqr::Reg)pdi.rs1;
+	rd = (TraceDqr::Reg)pdi.rd;
+	immediate = pdi.immediate;
 
 	switch (inst_type) {
 	case TraceDqr::INST_JALR:
@@ -7712,22 +9218,90 @@ TraceDqr::DQErr Trace::nextAddr(TraceDqr::ADDRESS addr,TraceDqr::ADDRESS &nextAd
 // The result is the address it stops at. It also consumes the counts (i-cnt,
 // history, taken, not-taken) when appropriate!
 
+// findNotTakenRun(): follow the straight-line code from the conditional branch at addr, as if it and the
+// branches after it are not taken, and count the conditional branches reached (including the one at addr)
+// before any other kind of jump. Stops at maxBranches, or where there is no predecode table (kernel memory).
+// lastBranch is set to the address of the last branch counted
+
+int Trace::findNotTakenRun(TraceDqr::ADDRESS addr,int maxBranches,TraceDqr::ADDRESS &lastBranch)
+{
+	int numBranches = 0;
+
+	// bounds the work done for a run with few branches in it
+
+	int numInsts = 0;
+
+	lastBranch = addr;
+
+	while ((numBranches < maxBranches) && (numInsts < 256)) {
+		const predecodedInst *pdip;
+
+		if ((kMem != nullptr) && (addr >= kMem->getKStart())) {
+			break;
+		}
+
+		pdip = currentElfReader[currentCore]->getPredecodedInstByAddress(addr,procCache[currentCore][0].sectionHint);
+		if (pdip == nullptr) {
+			break;
+		}
+
+		bool endOfRun = false;
+
+		switch ((TraceDqr::InstType)pdip->inst_type) {
+		case TraceDqr::INST_BEQ:
+		case TraceDqr::INST_BNE:
+		case TraceDqr::INST_BLT:
+		case TraceDqr::INST_BGE:
+		case TraceDqr::INST_BLTU:
+		case TraceDqr::INST_BGEU:
+		case TraceDqr::INST_C_BEQZ:
+		case TraceDqr::INST_C_BNEZ:
+			numBranches += 1;
+			lastBranch = addr;
+			break;
+		case TraceDqr::INST_JAL:
+		case TraceDqr::INST_JALR:
+		case TraceDqr::INST_C_J:
+		case TraceDqr::INST_C_JAL:
+		case TraceDqr::INST_C_JR:
+		case TraceDqr::INST_C_JALR:
+		case TraceDqr::INST_EBREAK:
+		case TraceDqr::INST_ECALL:
+		case TraceDqr::INST_MRET:
+		case TraceDqr::INST_SRET:
+		case TraceDqr::INST_URET:
+			endOfRun = true;
+			break;
+		default:
+			break;
+		}
+
+		if (endOfRun) {
+			break;
+		}
+
+		addr += pdip->inst_size / 8;
+		numInsts += 1;
+	}
+
+	return numBranches;
+}
+
 TraceDqr::DQErr Trace::nextAddr(int core,TraceDqr::ADDRESS addr,TraceDqr::ADDRESS &pc,NexusMessage *nm,int &crFlag,TraceDqr::BranchFlags &brFlag)
 {
 	TraceDqr::CountType ct;
-	uint32_t inst;
+	predecodedInst pdi;
 	int inst_size;
 	TraceDqr::InstType inst_type;
 	int32_t immediate;
-	bool isBranch;
 	int rc;
 	TraceDqr::Reg rs1;
 	TraceDqr::Reg rd;
 	bool isTaken;
 
-	status = getInstructionByAddress(addr,inst);
+	status = getPredecodedInstByAddress(addr,pdi);
 	if (status != TraceDqr::DQERR_OK) {
-		printf("Error: nextAddr(): getInstructionByAddress() failed\n");
+		printf("Error: nextAddr(): getPredecodedInstByAddress() failed\n");
 
 		return status;
 	}
@@ -7738,14 +9312,11 @@ TraceDqr::DQErr Trace::nextAddr(int core,TraceDqr::ADDRESS addr,TraceDqr::ADDRES
 	// figure out how big the instruction is
 	// Note: immediate will already be adjusted - don't need to mult by 2 before adding to address
 
-	rc = decodeInstruction(inst,inst_size,inst_type,rs1,rd,immediate,isBranch);
-	if (rc != 0) {
-		printf("Error: nextAddr(): Cannot decode instruction %04x\n",inst);
-
-		status = TraceDqr::DQERR_ERR;
-
-		return status;
-	}
+	inst_size = pdi.inst_size;
+	inst_type = (TraceDqr::InstType)pdi.inst_type;
+	rs1 = (TraceDqr::Reg)pdi.rs1;
+	rd = (TraceDqr::Reg)pdi.rd;
+	immediate = pdi.immediate;
 
 	switch (inst_type) {
 	case TraceDqr::INST_UNKNOWN:
@@ -7861,6 +9432,14 @@ TraceDqr::DQErr Trace::nextAddr(int core,TraceDqr::ADDRESS addr,TraceDqr::ADDRES
 		case TraceDqr::TRACETYPE_EVENT:
 			// htm mode
 
+			// a branch of the not-taken run whose history bits were consumed with an earlier branch
+
+			if (counts->consumeRunBranch(core,addr)) {
+				pc = addr + inst_size / 8;
+				brFlag = TraceDqr::BRFLAG_notTaken;
+				break;
+			}
+
 			ct = counts->getCurrentCountType(core);
 			switch (ct) {
 			case TraceDqr::COUNTTYPE_none:
@@ -7930,6 +9509,27 @@ TraceDqr::DQErr Trace::nextAddr(int core,TraceDqr::ADDRESS addr,TraceDqr::ADDRES
 
 				if (globalDebugFlag) printf("Debug: Conditional branch: Have history, taken mask: %08x, bit %d, taken: %d, core: %d\n",counts->getHistory(core),counts->getNumHistoryBits(core),counts->isTaken(core),core);
 
+				// if the history starts with several not-taken bits, find the branches they are for on the
+				// straight-line code from here and consume the bits for all of them at once. The run stops
+				// at the end of this message's history; the branch after it waits for the next message
+
+				int numNotTaken;
+
+				numNotTaken = counts->getNumNotTaken(core);
+
+				if (numNotTaken > 1) {
+					TraceDqr::ADDRESS lastBranch;
+					int numBranches;
+
+					numBranches = findNotTakenRun(addr,numNotTaken,lastBranch);
+
+					if ((numBranches > 1) && (counts->consumeNotTakenRun(core,numBranches,lastBranch) == 0)) {
+						pc = addr + inst_size / 8;
+						brFlag = TraceDqr::BRFLAG_notTaken;
+						break;
+					}
+				}
+
 				rc = counts->consumeHistory(core,isTaken);
 				if ( rc != 0) {
 					printf("Error: nextAddr(): consumeHistory() failed\n");
@@ -8294,54 +9894,53 @@ int Trace::processPidPriv(int core,int pid,uint8_t v,uint8_t prv)
 	currentPid[core] = pid;
 	currentPrv[core] = (v << 4) | prv;
 
-	int pidIndex;
+	// context switches mostly go back to a recently active process, so check the core's recent
+	// contexts first. Their section hints come back with them
+
+	processContext *pc = procCache[core];
+	processContext ctx;
+	int i;
 
-	if (numPids == 0) {
-		// if numPids == 0, tracing all pids
+	for (i = 0; (i < procCacheSize) && ((pc[i].processIndex == -2) || (pc[i].pid != pid)); i++) {
+		// search
+	}
 
-		pidIndex = 0;
+	if (i < procCacheSize) {
+		ctx = pc[i];
 	}
 	else {
-		pidIndex = -1;
+		ctx.pid = pid;
+		ctx.processIndex = findProcess(pid);
+		ctx.sectionHint = -1;
 
-		for (int i = 0; (i < numPids) && (pidIndex == -1); i++) {
-			if (pidList[i] == pid) {
-				pidIndex = i;
+		// linux processes are built the first time their pid shows up. If that fails, the pid
+		// is not decoded
+
+		if ((ctx.processIndex >= 0) && (processLoader != nullptr)) {
+			if (processLoader->getProcess(ctx.processIndex) != TraceDqr::DQERR_OK) {
+				ctx.processIndex = -1;
 			}
 		}
-	}
 
-	int processIndex;
+		// drop the least recently active context
 
-	processIndex = -1;
+		i = procCacheSize-1;
+	}
 
-	if (pidIndex >= 0) { // want to decode this pid
-		// see if we have process info for this pid
+	for ( ; i > 0; i--) {
+		pc[i] = pc[i-1];
+	}
 
-		if (processes[0].pid == -1) {
-			// bare metal trace
-			processIndex = 0;
-		}
-		else {
-			for (int i = 0; (i < numProcesses) && (processIndex == -1); i++) {
-				if (processes[i].pid == pid) {
-					processIndex = i;
-				}
-			}
-		}
+	pc[0] = ctx;
 
-		if (processIndex >= 0) { // have process info for this pid. Use it
-			currentProcessIndex[core] = processIndex;
-			currentDisassembler[core] = processes[processIndex].disassembler;
-			currentElfReader[core] = processes[processIndex].elfReader;
-		}
-		else { // no process info for this pid. Don't decode
-			currentProcessIndex[core] = -1;
-			currentDisassembler[core] = nullptr;
-			currentElfReader[core] = nullptr;
-		}
+	int processIndex = ctx.processIndex;
+
+	if (processIndex >= 0) { // have process info for this pid. Use it
+		currentProcessIndex[core] = processIndex;
+		currentDisassembler[core] = processes[processIndex].disassembler;
+		currentElfReader[core] = processes[processIndex].elfReader;
 	}
-	else { // not decoding this pid
+	else { // not decoding this pid, or no process info for it
 		currentProcessIndex[core] = -1;
 		currentDisassembler[core] = nullptr;
 		currentElfReader[core] = nullptr;
@@ -9283,6 +10882,8 @@ void Trace::resetTrace(int core)
       currentDisassembler[i] = processes[0].disassembler;
     }
 
+    resetProcCache(-1);
+
     currentCore = 0;	// as good as any!
   }
   else {
@@ -9322,6 +10923,8 @@ void Trace::resetTrace(int core)
     currentElfReader[core] = processes[0].elfReader;
 
     currentDisassembler[core] = processes[0].disassembler;
+
+    resetProcCache(core);
   }
 
   status = TraceDqr::DQERR_OK;
@@ -9367,6 +10970,10 @@ TraceDqr::DQErr Trace::getInstructionByAddress(TraceDqr::ADDRESS addr, Instructi
 
 TraceDqr::DQErr Trace::signExtendAddr(TraceDqr::ADDRESS &addr)
 {
+	if ((bitsPerAddress <= 0) || (bitsPerAddress >= 64)) {
+		return TraceDqr::DQERR_OK;
+	}
+
 	if (addr & ((uint64_t)1) << (bitsPerAddress-1)) {
 		addr |= ((uint64_t)0xffffffffffffffff) << (bitsPerAddress-1);
 	}
@@ -230,7 +230,7 @@ TraceDqr::DQErr VCD::configure(class TraceSettings &settings)
 			return TraceDqr::DQERR_ERR;
 		}
 
-		rc = elfReader->seal();
+		rc = elfReader->seal(0);
 		if (rc != TraceDqr::DQERR_OK) {
 			printf("Error: VCD:Configure(): Could not seal elfReader\n");
 
@@ -259,7 +259,7 @@ TraceDqr::DQErr VCD::configure(class TraceSettings &settings)
 
 	    // create disassembler object
 
-		disassembler = new (std::nothrow) Disassembler(symtab,sections,elfReader->getArchSize());
+		disassembler = new (std::nothrow) Disassembler(symtab,sections,elfReader->getSectionIndex(),elfReader->getArchSize());
 		if (disassembler == nullptr) {
 			printf("Error: VCD::Configure(): Could not create disassembler object\n");
 
@@ -292,18 +292,18 @@ TraceDqr::DQErr VCD::configure(class TraceSettings &settings)
 	instructionInfo.instSize = 0;
 
 	if (settings.numAddrBits != 0 ) {
-		instructionInfo.addrSize = settings.numAddrBits;
+		dispAddrSize() = settings.numAddrBits;
 	}
 	else if (elfReader == nullptr) {
-		instructionInfo.addrSize = 0;
+		dispAddrSize() = 0;
 	}
 	else {
-		instructionInfo.addrSize = elfReader->getBitsPerAddress();
+		dispAddrSize() = elfReader->getBitsPerAddress();
 	}
 
-	instructionInfo.addrDispFlags = settings.addrDispFlags;
+	dispAddrDispFlags() = settings.addrDispFlags;
 
-	instructionInfo.addrPrintWidth = (instructionInfo.addrSize + 3) / 4;
+	dispAddrPrintWidth() = (dispAddrSize() + 3) / 4;
 
 	instructionInfo.addressLabel = nullptr;
 	instructionInfo.addressLabelOffset = 0;
@@ -648,7 +648,7 @@ TraceDqr::DQErr VCD::Disassemble(uint64_t pc)
 		return TraceDqr::DQERR_ERR;
 	}
 
-	ec = disassembler->disassemble(pc);
+	ec = disassembler->disassemble(pc,0);
 	if (ec != TraceDqr::DQERR_OK ) {
 		status = TraceDqr::DQERR_ERR;
 		return TraceDqr::DQERR_ERR;